@@ -0,0 +1,393 @@
+/*
+ *	Benchmark
+ *	10/17/26 23:58
+ */
+
+#include <Framework/AccelerationSimulator.h>
+#include <Framework/Car.h>
+#include <Framework/Curve.h>
+#include <Framework/Files/ArchiveCache.h>
+#include <Framework/Files/FileManager.h>
+#include <Framework/Ini.h>
+#include <Framework/ShiftSolver.h>
+
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using Framework::AccelerationSimulator;
+using Framework::Car;
+using Framework::ErrorCode;
+using Framework::FloatCurve;
+using Framework::Ini;
+using Framework::ShiftSolver;
+using Framework::Files::ArchiveCache;
+using Framework::Files::File;
+using Framework::Files::FileManager;
+
+// the folder the benchmark works in, inside the directory it is given, which is all it ever deletes
+constexpr const char* WORK_DIRECTORY = "AssettoCorsaBenchmark.tmp";
+
+// the folder of the synthetic car, which the key is derived from
+constexpr const char* CAR_DIRECTORY = "benchmark_car";
+
+// every benchmark runs for at least this long after one warm up run
+constexpr double MIN_SECONDS = 0.5;
+
+// the number of points in the synthetic torque curve
+constexpr size_t LUT_POINTS = 1000;
+// the number of lookups per run of the lookup benchmarks
+constexpr size_t LOOKUPS = 4096;
+
+// results are added here so the compiler cannot drop the work
+volatile double g_sink = 0.0;
+
+struct Result
+{
+	std::string name;
+	uint64_t operations;
+	double seconds;
+	// bytes processed per operation, 0 if throughput does not apply
+	double bytesPerOperation;
+};
+
+// xorshift, so the corpus is the same on every run and platform
+uint32_t NextRandom(uint32_t& state)
+{
+	state ^= state << 13;
+	state ^= state >> 17;
+	state ^= state << 5;
+	return state;
+}
+
+// returns a power.lut with points every 10 rpm, with a hump of torque in the middle
+std::string GenerateLUT(size_t points)
+{
+	std::string lut = "; synthetic torque curve\n";
+
+	for (size_t i = 0; i < points; ++i)
+	{
+		const auto rpm = 1000 + static_cast<int>(i) * 10;
+		const auto position = static_cast<double>(i) / points;
+
+		lut += std::to_string(rpm) + '|' + std::to_string(static_cast<int>(300.0 + 200.0 * position * (1.0 - position) * 4.0)) + '\n';
+	}
+
+	return lut;
+}
+
+// writes a car archive at fileName with every file a car needs, and entryCount more files of entrySize random bytes.
+// returns the size of the decrypted contents
+size_t GenerateArchive(const std::string& fileName, size_t entryCount, size_t entrySize)
+{
+	FileManager manager(std::string(), CAR_DIRECTORY, FileManager::MODE_WRITE);
+
+	const auto lut = GenerateLUT(LUT_POINTS);
+	const auto redline = std::to_string(1000 + (LUT_POINTS - 1) * 10);
+
+	manager.AddFile(File("power.lut", lut));
+	manager.AddFile(File("engine.ini", "[HEADER]\nVERSION=1\n\n[ENGINE_DATA]\nALTITUDE_SENSITIVITY=0.1\nINERTIA=0.12\nLIMITER=" + redline + "\nMINIMUM=900\n"));
+	manager.AddFile(File("drivetrain.ini", "[HEADER]\nVERSION=3\n\n[TRACTION]\nTYPE=RWD\n\n[GEARS]\nCOUNT=6\nGEAR_R=-3.2\nGEAR_1=3.4\nGEAR_2=2.3\n"
+		"GEAR_3=1.7\nGEAR_4=1.3\nGEAR_5=1.05\nGEAR_6=0.85\nFINAL=3.9\n\n[GEARBOX]\nCHANGE_UP_TIME=80\nCHANGE_DN_TIME=120\n"));
+	manager.AddFile(File("tyres.ini", "[HEADER]\nVERSION=10\n\n[FRONT]\nNAME=Semislicks\nRADIUS=0.31\n\n[REAR]\nNAME=Semislicks\nRADIUS=0.33\n"));
+	manager.AddFile(File("car.ini", "[HEADER]\nVERSION=2\n\n[BASIC]\nGRAPHICS_OFFSET=0,-0.5,0\nTOTALMASS=1350\n"));
+	manager.AddFile(File("aero.ini", "[HEADER]\nVERSION=3\n\n[WING_0]\nNAME=BODY\nCHORD=2.0\nSPAN=1.1\nLUT_AOA_CD=body_aoa_cd.lut\nCD_GAIN=1\nANGLE=-5\n"));
+	manager.AddFile(File("body_aoa_cd.lut", "-10|0.30\n0|0.32\n10|0.40\n"));
+
+	uint32_t state = 0x9E3779B9;
+	for (size_t i = 0; i < entryCount; ++i)
+	{
+		std::string contents(entrySize, '\0');
+		for (auto& c : contents)
+			c = static_cast<char>(NextRandom(state));
+
+		char name[32];
+		snprintf(name, sizeof(name), "data_%04zu.bin", i);
+
+		manager.AddFile(File(name, std::move(contents)));
+	}
+
+	manager.WriteFiles(fileName);
+
+	size_t size = 0;
+	for (const auto& file : manager)
+		size += file.GetContentsView().size();
+
+	return size;
+}
+
+// runs func until MIN_SECONDS have passed, and adds how long it took to results. each run counts as
+// operationsPerRun operations, each of which processes bytesPerOperation bytes
+void Measure(std::vector<Result>& results, const std::string& name, uint64_t operationsPerRun, double bytesPerOperation, const std::function<void()>& func)
+{
+	// caches, page cache and lazily created state are warm before timing
+	func();
+
+	uint64_t runs = 0;
+	double seconds = 0.0;
+
+	const auto start = std::chrono::steady_clock::now();
+	do
+	{
+		func();
+		++runs;
+
+		seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	} while (seconds < MIN_SECONDS);
+
+	results.push_back({ name, runs * operationsPerRun, seconds, bytesPerOperation });
+}
+
+// prints the results as JSON
+void PrintResults(const std::vector<Result>& results, size_t entryCount, size_t entrySize, size_t archiveSize)
+{
+	std::cout << std::fixed << "{\"entry_count\":" << entryCount << ",\"entry_size\":" << entrySize << ",\"archive_size\":" << archiveSize << ",\"results\":[";
+
+	for (size_t i = 0; i < results.size(); ++i)
+	{
+		const auto& result = results[i];
+
+		std::cout << ((i == 0) ? "" : ",") << "\n{\"name\":\"" << result.name << "\",\"operations\":" << result.operations
+			<< ",\"ns_per_op\":" << std::setprecision(1) << result.seconds * 1e9 / result.operations;
+
+		if (result.bytesPerOperation > 0.0)
+			std::cout << ",\"mb_per_s\":" << std::setprecision(1) << result.bytesPerOperation * result.operations / result.seconds / 1e6;
+
+		std::cout << '}';
+	}
+
+	std::cout << "\n]}\n";
+}
+
+int main(int argc, char* argv[])
+{
+	if (argc > 4)
+	{
+		std::cout << "Usage: " << argv[0] << " [entryCount:int:64] [entrySize:int:262144] [workDirectory:string:temp]\n";
+		return 1;
+	}
+
+	const size_t entryCount = (argc >= 2) ? std::strtoul(argv[1], nullptr, 10) : 64;
+	const size_t entrySize = (argc >= 3) ? std::strtoul(argv[2], nullptr, 10) : 256 * 1024;
+	// only a folder of our own is created and deleted, never the directory we were given
+	const auto workDirectory = ((argc >= 4) ? std::filesystem::path(argv[3]) : std::filesystem::temp_directory_path()) / WORK_DIRECTORY;
+
+	// the key comes from the folder the archive is in
+	const auto carPath = workDirectory / CAR_DIRECTORY;
+	const auto dataFile = (carPath / "data.acd").string();
+
+	std::error_code fsError;
+	std::filesystem::remove_all(workDirectory, fsError);
+	std::filesystem::create_directories(carPath, fsError);
+
+	if (fsError)
+	{
+		std::cout << "Failed to create work directory\n";
+		return 1;
+	}
+
+	std::vector<Result> results;
+	size_t contentsSize = 0;
+
+	try
+	{
+		contentsSize = GenerateArchive(dataFile, entryCount, entrySize);
+
+		const auto contents = static_cast<double>(contentsSize);
+
+		// opening
+		Measure(results, "open_decrypt", 1, contents, [&]
+		{
+			const FileManager manager(dataFile, CAR_DIRECTORY, FileManager::MODE_READ);
+			g_sink = g_sink + manager.GetFiles().size();
+		});
+
+		Measure(results, "open_decrypt_mapped", 1, contents, [&]
+		{
+			const FileManager manager(dataFile, CAR_DIRECTORY, FileManager::MODE_READ | FileManager::MODE_MAP);
+			g_sink = g_sink + manager.GetFiles().size();
+		});
+
+		Measure(results, "open_decrypt_parallel", 1, contents, [&]
+		{
+			const FileManager manager(dataFile, CAR_DIRECTORY, FileManager::MODE_READ, 0);
+			g_sink = g_sink + manager.GetFiles().size();
+		});
+
+		Measure(results, "open_lazy", 1, 0.0, [&]
+		{
+			const FileManager manager(dataFile, CAR_DIRECTORY, FileManager::MODE_READ | FileManager::MODE_LAZY);
+			g_sink = g_sink + manager.FindFile("car.ini")->GetContentsView().size();
+		});
+
+		// the first open stores the image, the warm up run takes care of that
+		const ArchiveCache cache((workDirectory / "cache").string());
+		Measure(results, "open_cached", 1, contents, [&]
+		{
+			const FileManager manager(dataFile, CAR_DIRECTORY, FileManager::MODE_READ, 1, &cache);
+			g_sink = g_sink + manager.GetFiles().size();
+		});
+
+		// lookups
+		const FileManager manager(dataFile, CAR_DIRECTORY, FileManager::MODE_READ);
+
+		std::vector<std::string> names;
+		for (const auto& file : manager)
+			names.push_back(file.GetName());
+
+		Measure(results, "get_file", LOOKUPS, 0.0, [&]
+		{
+			size_t size = 0;
+			for (size_t i = 0; i < LOOKUPS; ++i)
+				size += manager.GetFile(names[i % names.size()]).GetContentsView().size();
+
+			g_sink = g_sink + size;
+		});
+
+		// optional files that are not there, which batch scans look up for every car
+		Measure(results, "get_file_missing", LOOKUPS, 0.0, [&]
+		{
+			size_t misses = 0;
+			for (size_t i = 0; i < LOOKUPS; ++i)
+			{
+				ErrorCode ec;
+				manager.GetFile((i % 2 == 0) ? "turbo.ini" : "ers.ini", ec);
+				misses += (ec != Framework::ErrorCode_SUCCESS);
+			}
+
+			g_sink = g_sink + misses;
+		});
+
+		// curves
+		const auto lut = GenerateLUT(LUT_POINTS);
+
+		Measure(results, "curve_parse_lut", 1, static_cast<double>(lut.size()), [&]
+		{
+			FloatCurve curve;
+			curve.ParseLUT(lut);
+			g_sink = g_sink + curve.GetRefs().size();
+		});
+
+		FloatCurve curve;
+		curve.ParseLUT(lut);
+
+		// spread over the whole curve, and a little past both ends
+		std::vector<FloatCurve::Ref_t> rpms(LOOKUPS);
+		for (size_t i = 0; i < LOOKUPS; ++i)
+			rpms[i] = static_cast<FloatCurve::Ref_t>(500 + i * (LUT_POINTS * 10 + 1000) / LOOKUPS);
+
+		std::vector<FloatCurve::Value_t> torques(LOOKUPS);
+
+		Measure(results, "curve_get_value", LOOKUPS, 0.0, [&]
+		{
+			float sum = 0.f;
+			for (size_t i = 0; i < LOOKUPS; ++i)
+				sum += curve.GetValue(rpms[(i * 2654435761u) % LOOKUPS]);
+
+			g_sink = g_sink + sum;
+		});
+
+		Measure(results, "curve_get_value_batch", LOOKUPS, 0.0, [&]
+		{
+			curve.GetValue(rpms.data(), torques.data(), LOOKUPS);
+			g_sink = g_sink + torques[LOOKUPS / 2];
+		});
+
+		// ini files
+		const auto drivetrain = manager.GetFile("drivetrain.ini").GetContentsView();
+
+		Measure(results, "ini_parse", 1, static_cast<double>(drivetrain.size()), [&]
+		{
+			const Ini ini(drivetrain);
+			g_sink = g_sink + ini.HasSection("GEARS");
+		});
+
+		const Ini ini(drivetrain);
+
+		Measure(results, "ini_get_value", 8, 0.0, [&]
+		{
+			float sum = ini.GetValue<float>("GEARS", "FINAL");
+			for (int gear = 1; gear <= 6; ++gear)
+				sum += ini.GetValue<float>("GEARS", "GEAR_" + std::to_string(gear));
+
+			sum += ini.GetValue<int32_t>("GEARS", "COUNT");
+			g_sink = g_sink + sum;
+		});
+
+		Measure(results, "ini_get_value_missing", 8, 0.0, [&]
+		{
+			float sum = 0.f;
+			for (int gear = 7; gear <= 14; ++gear)
+			{
+				ErrorCode ec;
+				sum += ini.GetValue<float>("GEARS", "GEAR_" + std::to_string(gear), ec);
+			}
+
+			g_sink = g_sink + sum;
+		});
+
+		Measure(results, "car_load", 1, 0.0, [&]
+		{
+			const FileManager carManager(dataFile, CAR_DIRECTORY, FileManager::MODE_READ | FileManager::MODE_LAZY);
+			const Car car(carManager);
+			g_sink = g_sink + car.GetRedline();
+		});
+
+		const Car car(manager);
+
+		// the wing runs at -5, halfway between the first two points of its LUT, so those points must have been kept
+		if (std::abs(car.GetDragArea() - 2.0f * 1.1f * 0.31f) > 1e-4f)
+		{
+			std::cout << "The drag area of the benchmark car is " << car.GetDragArea() << ", the negative angles of its aero LUT were lost\n";
+			throw ErrorCode(Framework::ErrorCode_FORMAT);
+		}
+
+		const AccelerationSimulator simulator(car);
+
+		Measure(results, "simulator_run", 1, 0.0, [&]
+		{
+			g_sink = g_sink + simulator.Run(AccelerationSimulator::ShiftPoints_t()).time200;
+		});
+
+		const Car shiftCar(manager, Car::PART_ENGINE | Car::PART_GEARBOX);
+
+		Measure(results, "shift_solve", 1, 0.0, [&]
+		{
+			const ShiftSolver solver(shiftCar);
+			g_sink = g_sink + solver.Solve().back();
+		});
+
+		// what the shift optimizer does for each car, from the archive to the result
+		Measure(results, "pipeline", 1, 0.0, [&]
+		{
+			const FileManager carManager(dataFile, CAR_DIRECTORY, FileManager::MODE_READ | FileManager::MODE_LAZY);
+			const Car pipelineCar(carManager, Car::PART_ENGINE | Car::PART_GEARBOX);
+			g_sink = g_sink + ShiftSolver(pipelineCar).Solve().back();
+		});
+
+		Measure(results, "simulator_optimize", 1, 0.0, [&]
+		{
+			AccelerationSimulator::ShiftPoints_t shiftPoints;
+			g_sink = g_sink + simulator.Optimize(shiftPoints).time200;
+		});
+	}
+	catch (const ErrorCode& ec)
+	{
+		std::cout << "Error: " << ec.GetMessage() << " (" << std::to_string(ec.GetRawCode()) << ")\n";
+		return 1;
+	}
+
+	std::filesystem::remove_all(workDirectory, fsError);
+
+	PrintResults(results, entryCount, entrySize, contentsSize);
+
+	return 0;
+}
@@ -3,15 +3,34 @@
  *	9/8/19 20:50
  */
 
+#include <Framework/Diagnostics.h>
+#include <Framework/Files/ArchiveCache.h>
 #include <Framework/Files/FileManager.h>
+#include <Framework/Files/FileWriter.h>
+#include <Framework/ThreadPool.h>
+#include <Framework/Trace.h>
 
+#include <algorithm>
+#include <cstdlib>
 #include <filesystem>
-#include <fstream>
 #include <iostream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
 
 using Framework::ErrorCode;
+using Framework::Files::ArchiveCache;
 using Framework::Files::File;
 using Framework::Files::FileManager;
+using Framework::Files::FileWriter;
+
+// output is written on its own threads, so it overlaps with decryption
+constexpr size_t WRITER_THREADS = 4;
+
+// files are decrypted and written in pieces of this size, so large files never sit in memory whole
+constexpr size_t CHUNK_SIZE = 16 * 1024 * 1024;
 
 std::string GetWorkingDirectory()
 {
@@ -31,106 +50,242 @@ std::string GetWorkingDirectory()
 	return folderName;
 }
 
-int main(int argc, char* argv[])
+// queues every file in an archive to be written to outPath by writer, or only fileName if it is not empty.
+// callback is passed to writer with every file. cache may be nullptr. returns false on failure, with the failure in error
+bool DumpArchive(const std::string& dataFile, const std::string& directory, const std::string& outPath, const std::string& fileName,
+	FileWriter& writer, const FileWriter::Callback_t& callback, const ArchiveCache* cache, std::string& error)
 {
-	if (argc > 5)
+	const Framework::Trace::Span span("dump archive", dataFile);
+
+	// files are only decrypted when they are requested or handed to the writer, so memory stays bounded.
+	// the cache needs every file for its image, so with a cache the archive is decrypted whole once, and mapped from then on
+	const auto mode = (cache == nullptr) ? FileManager::MODE_LAZY : FileManager::MODE_MAP;
+
+	ErrorCode ec;
+	FileManager manager(dataFile, directory, FileManager::MODE_READ | mode, ec, 1, cache);
+
+	if (ec != Framework::ErrorCode_SUCCESS)
 	{
-		std::cout << "Usage: " << argv[0] << " [dataFile:string:data.acd] [directory:string:wd] [outDirectory:string:dataFileMinusExt] [fileName:string[OPT]]\n";
-		return 1;
+		error = "Error: " + std::string(ec.GetMessage()) + " (" + std::to_string(ec.GetRawCode()) + ")";
+		return false;
 	}
 
-	std::string dataFile = (argc >= 2) ? argv[1] : "data.acd";
-	std::string directory = (argc >= 3) ? argv[2] : GetWorkingDirectory();
-	
-	// if they specified an output folder path, use that instead of dataFileMinusExt
-	std::string outPath;
-	if (argc >= 4)
+	if (fileName.empty() == true)
 	{
-		outPath = argv[3];
+		// user did not specify a specific file to decrypt, decrypting and saving all to path.
+		// files are decrypted a chunk at a time into one buffer, and the writer copies each chunk until it is written,
+		// so memory stays bounded however large a file is
+		manager.VisitFiles([&](std::string_view name, File::View_t chunk, size_t offset, size_t size)
+		{
+			writer.WriteChunk(outPath + std::string(name), chunk, offset, size, callback);
+		}, CHUNK_SIZE);
 	}
 	else
 	{
-		auto ext = dataFile.find_first_of('.');
-		if (ext != std::string::npos)
-			outPath = dataFile.substr(0, ext);
-		else
-			outPath = dataFile;
+		// user specified a specific file to decrypt
+		const auto& file = manager.GetFile(fileName, ec);
+
+		// can we find the file?
+		if (ec != Framework::ErrorCode_SUCCESS)
+		{
+			error = "Error decrypting file: " + std::string(ec.GetMessage()) + " (" + std::to_string(ec.GetRawCode()) + ")";
+			return false;
+		}
+
+		writer.Write(outPath + fileName, file, callback);
 	}
-	// append a slash for use later when appending file name for output
-	outPath += '/';
 
-	ErrorCode ec;
-	FileManager manager(dataFile, directory, FileManager::MODE_READ, ec);
+	return true;
+}
 
-	if (ec != Framework::ErrorCode_SUCCESS)
+// dumps the data.acd of every car folder in carsPath across threadCount threads, and prints a summary.
+// each car is dumped to outRoot/car, or to its own data folder if outRoot is empty. archives are cached in cacheDirectory
+// unless it is empty. returns the number of failures
+size_t DumpCars(const std::string& carsPath, const std::string& outRoot, size_t threadCount, const std::string& cacheDirectory)
+{
+	struct Car
 	{
-		std::cout << "Error: " << ec.GetMessage() << " (" << ec.GetRawCode() << ")\n";
-		return 1;
-	}
+		std::filesystem::path path;
+		// empty unless the archive could not be read, or one of its files could not be written
+		std::string error;
+	};
+
+	std::vector<Car> cars;
 
-	// create the output directory if it does not exist
-	if (std::filesystem::is_directory(outPath) == false)
+	std::error_code fsError;
+	for (const auto& entry : std::filesystem::directory_iterator(carsPath, fsError))
 	{
-		if (std::filesystem::create_directory(outPath) == false)
-		{
-			std::cout << "Failed to create data directory\n";
-			return 1;
-		}
+		// only cars with an archive are of interest
+		if (entry.is_directory() == true && std::filesystem::is_regular_file(entry.path() / "data.acd") == true)
+			cars.push_back({ entry.path(), std::string() });
 	}
 
-	std::ofstream outFile;
+	if (fsError)
+	{
+		std::cout << "Failed to read cars directory\n";
+		return 1;
+	}
 
-	if (argc < 4)
+	std::unique_ptr<ArchiveCache> cache;
+	if (cacheDirectory.empty() == false)
 	{
-		// user did not specify a specific file to decrypt, decrypting and saving all to path
-		auto files = manager.GetFiles();
+		ErrorCode ec;
+		cache = std::make_unique<ArchiveCache>(cacheDirectory, ec);
 
 		if (ec != Framework::ErrorCode_SUCCESS)
 		{
-			std::cout << "Error decrypting files: " << ec.GetMessage() << " (" << ec.GetRawCode() << ")\n";
+			std::cout << "Failed to create cache directory\n";
 			return 1;
 		}
+	}
+
+	// keep the summary in a stable order
+	std::sort(cars.begin(), cars.end(), [](const Car& lhs, const Car& rhs) { return lhs.path < rhs.path; });
+
+	// writes from every car share the writer threads, and overlap with decryption
+	FileWriter writer(WRITER_THREADS);
+	std::mutex writeMutex;
 
-		for (const auto& file : files)
+	// cars vary a lot in size, so workers steal from each other as they finish
+	Framework::ThreadPool pool(threadCount);
+	for (auto& car : cars)
+	{
+		pool.Submit([&car, &outRoot, &writer, &writeMutex, &cache]
 		{
-			outFile.open(outPath + file.GetName());
+			// the key comes from the car's folder name
+			const auto directory = car.path.filename().string();
+			const auto outPath = ((outRoot.empty() == true) ? (car.path / "data") : (std::filesystem::path(outRoot) / directory)).string() + '/';
 
-			if (outFile.good() == false)
+			// remember the first file of this car that could not be written
+			const auto callback = [&car, &writeMutex](const std::string& path, const ErrorCode& ec)
 			{
-				std::cout << "Failed to open output file\n";
-				return 1;
+				if (ec == Framework::ErrorCode_SUCCESS)
+					return;
+
+				std::lock_guard<std::mutex> lock(writeMutex);
+
+				if (car.error.empty() == true)
+					car.error = "Failed to write " + path;
+			};
+
+			std::string error;
+			if (DumpArchive((car.path / "data.acd").string(), directory, outPath, std::string(), writer, callback, cache.get(), error) == false)
+			{
+				std::lock_guard<std::mutex> lock(writeMutex);
+
+				if (car.error.empty() == true)
+					car.error = error;
 			}
+		});
+	}
+	pool.Wait();
+	writer.Wait();
 
-			outFile << file.GetContents();
-			outFile.close();
+	size_t failures = 0;
+	for (const auto& car : cars)
+	{
+		// a car succeeded if both its archive and all of its files could be written
+		if (car.error.empty() == true)
+		{
+			std::cout << "OK     " << car.path.filename().string() << '\n';
+			continue;
 		}
+
+		std::cout << "FAILED " << car.path.filename().string() << ": " << car.error << '\n';
+		++failures;
 	}
-	else
-	{
-		// user specified a specific file to decrypt
 
-		std::string fileName = argv[4];
-		
-		const auto file = manager.GetFile(fileName, ec);
+	std::cout << "Dumped " << cars.size() - failures << " of " << cars.size() << " cars\n";
 
-		// can we find the file?
-		if (ec != Framework::ErrorCode_SUCCESS)
+	return failures;
+}
+
+// runs the tool with the arguments other than --stats
+int Run(int argc, char* argv[])
+{
+	// batch mode dumps every car in a cars folder
+	if (argc >= 2 && std::string(argv[1]) == "--batch")
+	{
+		if (argc > 6)
 		{
-			std::cout << "Error decrypting file: " << ec.GetMessage() << " (" << ec.GetRawCode() << ")\n";
+			std::cout << "Usage: " << argv[0] << " --batch [carsDirectory:string:wd] [outDirectory:string:carDirectory/data] [threads:int:hw] [cacheDirectory:string[OPT]]\n";
 			return 1;
 		}
 
-		outFile.open(outPath + fileName);
+		const std::string carsPath = (argc >= 3) ? argv[2] : std::filesystem::current_path().string();
+		const std::string outRoot = (argc >= 4) ? argv[3] : std::string();
+		const size_t threadCount = (argc >= 5) ? std::strtoul(argv[4], nullptr, 10) : 0;
+		const std::string cacheDirectory = (argc >= 6) ? argv[5] : std::string();
 
-		if (outFile.good() == false)
-		{
-			std::cout << "Failed to open output file\n";
-			return 1;
-		}
+		return (DumpCars(carsPath, outRoot, threadCount, cacheDirectory) == 0) ? 0 : 1;
+	}
+
+	if (argc > 5)
+	{
+		std::cout << "Usage: " << argv[0] << " [dataFile:string:data.acd] [directory:string:wd] [outDirectory:string:dataFileMinusExt] [fileName:string[OPT]]\n";
+		std::cout << "       " << argv[0] << " --batch [carsDirectory:string:wd] [outDirectory:string:carDirectory/data] [threads:int:hw] [cacheDirectory:string[OPT]]\n";
+		std::cout << Framework::Diagnostics::GetUsage() << '\n';
+		return 1;
+	}
+
+	std::string dataFile = (argc >= 2) ? argv[1] : "data.acd";
+	std::string directory = (argc >= 3) ? argv[2] : GetWorkingDirectory();
+	
+	// if they specified an output folder path, use that instead of dataFileMinusExt
+	std::string outPath;
+	if (argc >= 4)
+	{
+		outPath = argv[3];
+	}
+	else
+	{
+		auto ext = dataFile.find_first_of('.');
+		if (ext != std::string::npos)
+			outPath = dataFile.substr(0, ext);
+		else
+			outPath = dataFile;
+	}
+	// append a slash for use later when appending file name for output
+	outPath += '/';
 
-		outFile << file.GetContents();
-		outFile.close();
+	const std::string fileName = (argc >= 5) ? argv[4] : std::string();
+
+	FileWriter writer(WRITER_THREADS);
+
+	std::string error;
+	if (DumpArchive(dataFile, directory, outPath, fileName, writer, nullptr, nullptr, error) == false)
+	{
+		std::cout << error << '\n';
+		return 1;
+	}
+
+	if (writer.Wait() != 0)
+	{
+		std::cout << "Failed to write output file\n";
+		return 1;
 	}
 
 	return 0;
+}
+
+int main(int argc, char* argv[])
+{
+	// --stats and --trace can go anywhere, the other arguments keep their order
+	std::vector<char*> args(argv, argv + argc);
+
+	ErrorCode ec;
+	const Framework::Diagnostics diagnostics(args, ec);
+
+	if (ec != Framework::ErrorCode_SUCCESS)
+	{
+		std::cout << "--trace needs a file to write the trace to\n";
+		return 1;
+	}
+
+	const auto result = Run(static_cast<int>(args.size()), args.data());
+
+	// on stderr, so it never mixes with the output
+	diagnostics.Report(std::cerr);
+
+	return result;
 }
\ No newline at end of file
@@ -1,20 +1,35 @@
+#include <Framework/Car.h>
 #include <Framework/Curve.h>
+#include <Framework/Diagnostics.h>
+#include <Framework/Files/ArchiveCache.h>
 #include <Framework/Files/FileManager.h>
-
-#include "inipp.h"
-
+#include <Framework/GearingSearch.h>
+#include <Framework/Ini.h>
+#include <Framework/Json.h>
+#include <Framework/ShiftSolver.h>
+#include <Framework/ThreadPool.h>
+#include <Framework/Trace.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
 #include <filesystem>
+#include <iomanip>
 #include <iostream>
-#include <sstream>
+#include <memory>
 #include <string>
+#include <vector>
 
 /*
  *	Shift Optimizer
  *	9/8/19 22:40
  */
 
-using Framework::Curve;
 using Framework::ErrorCode;
+using Framework::GearingSearch;
+using Framework::Ini;
+using Framework::Files::ArchiveCache;
 using Framework::Files::File;
 using Framework::Files::FileManager;
 
@@ -36,197 +51,394 @@ std::string GetWorkingDirectory()
 	return folderName;
 }
 
-// returns false on failure, with the failure in ec
-bool GetRedline(FileManager& manager, int& redline, ErrorCode& ec)
+// the shift points of one car
+struct ShiftTable
+{
+	int redline = -1;
+	// the shift point from each gear to the next. redline to go to redline, negative if the next gear is always better
+	std::vector<double> shiftPoints;
+};
+
+// reads a car's archive and solves its shift points. cache may be nullptr. returns false on failure, with the failure in error
+bool OptimizeCar(const std::string& dataFile, const std::string& directory, const ArchiveCache* cache, ShiftTable& table, std::string& error)
 {
-	// find redline in engine.ini
-	const auto engine = manager.GetFile("engine.ini", ec);
+	const Framework::Trace::Span span("optimize car", dataFile);
 
-	// check for errors
+	ErrorCode ec;
+	// we only need a handful of files, so only decrypt the ones we ask for
+	FileManager manager(dataFile, directory, FileManager::MODE_READ | FileManager::MODE_LAZY, ec, 1, cache);
+
+	// make sure we initialized the decrypter properly
 	if (ec != Framework::ErrorCode_SUCCESS)
+	{
+		error = "Error creating decrypter: " + std::string(ec.GetMessage()) + " (" + std::to_string(ec.GetRawCode()) + ")";
 		return false;
+	}
 
-	// place the string in a stringstream to assist the ini parser
-	std::stringstream iniFile(engine.GetContents());
-
-	inipp::Ini<char> iniParser;
-	
-	// parse the ini for ENGINE_DATA->LIMITER
-	iniParser.parse(iniFile);
+	// only the engine and gearbox decide the shift points, so nothing else is decrypted
+	const Framework::Car car(manager, ec, Framework::Car::PART_ENGINE | Framework::Car::PART_GEARBOX);
 
-	auto res = inipp::extract(iniParser.sections["ENGINE_DATA"]["LIMITER"], redline);
+	if (ec != Framework::ErrorCode_SUCCESS)
+	{
+		error = "Error reading car: " + std::string(ec.GetMessage()) + " (" + std::to_string(ec.GetRawCode()) + ")";
+		return false;
+	}
 
-	if (res == false)
-		ec = ErrorCode(Framework::ErrorCode_FORMAT);
+	table.redline = car.GetRedline();
+	table.shiftPoints = Framework::ShiftSolver(car).Solve();
 
-	return res;
+	return true;
 }
 
-// returns false on failure, with the failure in ec
-//																   forward final
-bool GetGearRatios(FileManager& manager, std::pair<std::vector<float>, float>& gearRatios, ErrorCode& ec)
+// quotes a CSV field if it needs to be
+std::string EscapeCSV(const std::string& field)
 {
-	// find gearing information in drivetrain.ini
-	const auto drivetrain = manager.GetFile("drivetrain.ini", ec);
+	if (field.find_first_of(",\"\r\n") == std::string::npos)
+		return field;
 
-	// check for errors
-	if (ec != Framework::ErrorCode_SUCCESS)
-		return false;
+	std::string escaped = "\"";
+	for (const auto c : field)
+	{
+		if (c == '"')
+			escaped += '"';
+		escaped += c;
+	}
 
-	// place the string in a stringstream to assist the ini parser
-	std::stringstream iniFile(drivetrain.GetContents());
+	return escaped + '"';
+}
 
-	inipp::Ini<char> iniParser;
+enum class OutputFormat
+{
+	CSV,
+	JSON,
+};
 
-	// parse the ini for GEARS->COUNT, GEARS->GEAR_[1-COUNT], and GEARS->FINAL
-	iniParser.parse(iniFile);
+// solves the shift points of every car folder in carsPath across threadCount threads, and prints them in format
+// along with how long each car took. archives are cached in cacheDirectory unless it is empty. returns the number of failures
+size_t OptimizeCars(const std::string& carsPath, OutputFormat format, size_t threadCount, const std::string& cacheDirectory)
+{
+	struct Car
+	{
+		std::filesystem::path path;
+		ShiftTable table;
+		// empty unless the car could not be optimized
+		std::string error;
+		double milliseconds = 0.0;
+	};
 
-	// only call operator[] once, we will be referencing GEARS a lot
-	auto gears = iniParser.sections["GEARS"];
+	std::vector<Car> cars;
 
-	int gearCount = -1;
+	std::error_code fsError;
+	for (const auto& entry : std::filesystem::directory_iterator(carsPath, fsError))
+	{
+		// only cars with an archive are of interest
+		if (entry.is_directory() == true && std::filesystem::is_regular_file(entry.path() / "data.acd") == true)
+			cars.push_back({ entry.path(), ShiftTable(), std::string(), 0.0 });
+	}
 
-	// get the number of gears
-	if (inipp::extract(gears["COUNT"], gearCount) == false || gearCount < 0)
+	if (fsError)
 	{
-		ec = ErrorCode(Framework::ErrorCode_FORMAT);
-		return false;
+		std::cout << "Failed to read cars directory\n";
+		return 1;
 	}
 
-	std::string gearPrefix = "GEAR_";
-	gearRatios.first.resize(gearCount);
-	for (size_t gear = 1; gear <= gearCount; ++gear)
+	std::unique_ptr<ArchiveCache> cache;
+	if (cacheDirectory.empty() == false)
 	{
-		// extract ratios, and add them to the end
-		if (inipp::extract(gears[gearPrefix + std::to_string(gear)], gearRatios.first[gear - 1]) == false)
+		ErrorCode ec;
+		cache = std::make_unique<ArchiveCache>(cacheDirectory, ec);
+
+		if (ec != Framework::ErrorCode_SUCCESS)
 		{
-			ec = ErrorCode(Framework::ErrorCode_FORMAT);
-			return false;
+			std::cout << "Failed to create cache directory\n";
+			return 1;
 		}
 	}
 
-	// get the final drive ratio
-	if (inipp::extract(gears["FINAL"], gearRatios.second) == false)
+	// keep the output in a stable order
+	std::sort(cars.begin(), cars.end(), [](const Car& lhs, const Car& rhs) { return lhs.path < rhs.path; });
+
+	// every car is decrypted, parsed and solved on its own
+	Framework::ThreadPool pool(threadCount);
+	for (auto& car : cars)
 	{
-		ec = ErrorCode(Framework::ErrorCode_FORMAT);
-		return false;
+		pool.Submit([&car, &cache]
+		{
+			const auto start = std::chrono::steady_clock::now();
+
+			// the key comes from the car's folder name
+			OptimizeCar((car.path / "data.acd").string(), car.path.filename().string(), cache.get(), car.table, car.error);
+
+			car.milliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+		});
 	}
+	pool.Wait();
 
-	return true;
+	size_t failures = 0;
+
+	std::cout << std::fixed;
+
+	if (format == OutputFormat::CSV)
+	{
+		// one row per gear, or one row with the error if the car failed
+		std::cout << "car,gear,next_gear,shift_rpm,redline,time_ms,error\n";
+
+		for (const auto& car : cars)
+		{
+			const auto name = EscapeCSV(car.path.filename().string());
+
+			if (car.error.empty() == false)
+			{
+				std::cout << name << ",,,,," << std::setprecision(3) << car.milliseconds << ',' << EscapeCSV(car.error) << '\n';
+				++failures;
+				continue;
+			}
+
+			for (size_t i = 0; i < car.table.shiftPoints.size(); ++i)
+			{
+				std::cout << name << ',' << i + 1 << ',' << i + 2 << ',';
+
+				// the next gear is always better, there is no shift point
+				if (car.table.shiftPoints[i] >= 0.0)
+					std::cout << std::setprecision(1) << car.table.shiftPoints[i];
+
+				std::cout << ',' << car.table.redline << ',' << std::setprecision(3) << car.milliseconds << ",\n";
+			}
+		}
+	}
+	else
+	{
+		std::cout << "{\"cars\":[";
+
+		for (size_t i = 0; i < cars.size(); ++i)
+		{
+			const auto& car = cars[i];
+
+			std::cout << ((i == 0) ? "" : ",") << "\n{\"car\":\"" << Framework::Json::Escape(car.path.filename().string()) << "\",\"time_ms\":" << std::setprecision(3) << car.milliseconds;
+
+			if (car.error.empty() == false)
+			{
+				std::cout << ",\"error\":\"" << Framework::Json::Escape(car.error) << "\"}";
+				++failures;
+				continue;
+			}
+
+			std::cout << ",\"redline\":" << car.table.redline << ",\"shifts\":[";
+
+			for (size_t gear = 0; gear < car.table.shiftPoints.size(); ++gear)
+			{
+				std::cout << ((gear == 0) ? "" : ",") << "{\"gear\":" << gear + 1 << ",\"next_gear\":" << gear + 2 << ",\"shift_rpm\":";
+
+				// the next gear is always better, there is no shift point
+				if (car.table.shiftPoints[gear] >= 0.0)
+					std::cout << std::setprecision(1) << car.table.shiftPoints[gear];
+				else
+					std::cout << "null";
+
+				std::cout << '}';
+			}
+
+			std::cout << "]}";
+		}
+
+		std::cout << "\n]}\n";
+	}
+
+	return failures;
 }
 
-// returns false on failure, with the failure in ec
-bool GetTorqueCurve(FileManager& manager, Curve& torqueCurve, ErrorCode& ec)
+// reads count comma separated numbers from text. returns false if there are not exactly count
+bool ParseNumbers(const std::string& text, float* numbers, size_t count)
 {
-	// get power.lut
-	const auto power = manager.GetFile("power.lut", ec);
+	const char* position = text.c_str();
 
-	if (ec != Framework::ErrorCode_SUCCESS)
-		return false;
+	for (size_t i = 0; i < count; ++i)
+	{
+		char* end;
+		numbers[i] = std::strtof(position, &end);
 
-	// put the file in a stringstream to assist the LUT parser
-	std::stringstream powerFile(power.GetContents());
+		if (end == position || *end != ((i + 1 == count) ? '\0' : ','))
+			return false;
 
-	torqueCurve.ParseLUT(powerFile, ec);
+		position = end + 1;
+	}
 
 	return true;
 }
 
-int main(int argc, char* argv[])
+// searches the gearings of a car with the most wheel force across a speed range, then times the best of them
+// from standstill and prints them as drivetrain.ini values. returns false on failure, with the failure in error
+bool SearchGearing(const std::string& dataFile, const std::string& directory, const GearingSearch::Range& ratioRange, const GearingSearch::Range& finalRange,
+	float minSpeed, float maxSpeed, size_t count, size_t threadCount, std::string& error)
 {
-	// make sure we don't have too many args
-	if (argc > 3)
+	ErrorCode ec;
+	FileManager manager(dataFile, directory, FileManager::MODE_READ | FileManager::MODE_LAZY, ec);
+
+	if (ec != Framework::ErrorCode_SUCCESS)
 	{
-		std::cout << "Usage: " << argv[0] << " [dataFile:string:data.acd] [directory:string:wd]\n";
-		return 1;
+		error = "Error: " + std::string(ec.GetMessage()) + " (" + std::to_string(ec.GetRawCode()) + ")";
+		return false;
 	}
 
-	std::string dataFile = (argc >= 2) ? argv[1] : "data.acd";
-	std::string directory = (argc >= 3) ? argv[2] : GetWorkingDirectory();
+	const Framework::Car car(manager, ec);
 
-	ErrorCode ec;
-	FileManager manager(dataFile, directory, FileManager::MODE_READ, ec);
-
-	// make sure we initialized the decrypter properly
 	if (ec != Framework::ErrorCode_SUCCESS)
 	{
-		std::cout << "Error creating decrypter: " << ec.GetMessage() << " (" << ec.GetRawCode() << ")\n";
-		return 1;
+		error = "Error reading car: " + std::string(ec.GetMessage()) + " (" + std::to_string(ec.GetRawCode()) + ")";
+		return false;
 	}
 
-	int redline = -1;
+	const GearingSearch search(car, ratioRange, finalRange, minSpeed, maxSpeed, threadCount);
 
-	// get redline information
-	if (GetRedline(manager, redline, ec) == false || redline < 0)
+	auto candidates = search.Search(count);
+
+	if (candidates.empty() == true)
 	{
-		std::cout << "Failed to get redline information: " << ec.GetMessage() << " (" << ec.GetRawCode() << ")\n";
-		return 1;
+		error = "The ratio range has fewer ratios than the car has gears";
+		return false;
 	}
 
-	std::pair<std::vector<float>, float> gearRatios;
+	// the force only looks at one speed at a time, timing a run also counts shifts and drag
+	search.Simulate(candidates);
+
+	std::cout << std::fixed;
 
-	// get gear ratio information
-	if (GetGearRatios(manager, gearRatios, ec) == false || gearRatios.first.size() == 0 || gearRatios.second < 0.f)
+	for (size_t i = 0; i < candidates.size(); ++i)
 	{
-		std::cout << "Failed to get gear ratio information: " << ec.GetMessage() << " (" << ec.GetRawCode() << ")\n";
-		return 1;
+		const auto& candidate = candidates[i];
+
+		std::cout << "; #" << i + 1 << ", average force " << std::setprecision(0) << candidate.averageForce << " N";
+
+		// times of -1 were not reached
+		if (candidate.times.time100 >= 0.0)
+			std::cout << ", 0-100 " << std::setprecision(2) << candidate.times.time100 << " s";
+		if (candidate.times.time200 >= 0.0)
+			std::cout << ", 0-200 " << std::setprecision(2) << candidate.times.time200 << " s";
+
+		std::cout << "\n[GEARS]\n";
+
+		for (size_t gear = 0; gear < candidate.gearRatios.size(); ++gear)
+			std::cout << "GEAR_" << gear + 1 << '=' << std::setprecision(3) << candidate.gearRatios[gear] << '\n';
+
+		std::cout << "FINAL=" << std::setprecision(3) << candidate.finalRatio << "\n\n";
 	}
 
-	Curve torqueCurve;
+	return true;
+}
 
-	// get torque curve
-	if (GetTorqueCurve(manager, torqueCurve, ec) == false || torqueCurve.GetMaxRef() == 0)
+// runs the tool with the arguments other than --stats
+int Run(int argc, char* argv[])
+{
+	// gearing mode searches gear and final drive ratios for a car
+	if (argc >= 2 && std::string(argv[1]) == "--gearing")
 	{
-		std::cout << "Failed to get torque curve: " << ec.GetMessage() << " (" << ec.GetRawCode() << ")\n";
+		float ratios[3] = { 0.5f, 4.f, 0.05f };
+		float finals[3] = { 2.5f, 5.f, 0.25f };
+		float speeds[2] = { 0.f, 250.f };
+
+		if (argc > 9 || (argc >= 5 && ParseNumbers(argv[4], ratios, 3) == false) || (argc >= 6 && ParseNumbers(argv[5], finals, 3) == false)
+			|| (argc >= 7 && ParseNumbers(argv[6], speeds, 2) == false))
+		{
+			std::cout << "Usage: " << argv[0] << " --gearing [dataFile:string:data.acd] [directory:string:wd] [ratios:min,max,step:0.5,4,0.05] [finals:min,max,step:2.5,5,0.25] [speeds:min,max:0,250] [count:int:5] [threads:int:hw]\n";
+			return 1;
+		}
+
+		const std::string dataFile = (argc >= 3) ? argv[2] : "data.acd";
+		const std::string directory = (argc >= 4) ? argv[3] : GetWorkingDirectory();
+		const size_t count = (argc >= 8) ? std::strtoul(argv[7], nullptr, 10) : 5;
+		const size_t threadCount = (argc >= 9) ? std::strtoul(argv[8], nullptr, 10) : 0;
+
+		std::string error;
+		if (SearchGearing(dataFile, directory, { ratios[0], ratios[1], ratios[2] }, { finals[0], finals[1], finals[2] }, speeds[0], speeds[1], count, threadCount, error) == false)
+		{
+			std::cout << error << '\n';
+			return 1;
+		}
+
+		return 0;
+	}
+
+	// batch mode optimizes every car in a cars folder
+	if (argc >= 2 && std::string(argv[1]) == "--batch")
+	{
+		const std::string formatName = (argc >= 4) ? argv[3] : "csv";
+
+		if (argc > 6 || (formatName != "csv" && formatName != "json"))
+		{
+			std::cout << "Usage: " << argv[0] << " --batch [carsDirectory:string:wd] [format:csv|json:csv] [threads:int:hw] [cacheDirectory:string[OPT]]\n";
+			return 1;
+		}
+
+		const std::string carsPath = (argc >= 3) ? argv[2] : std::filesystem::current_path().string();
+		const auto format = (formatName == "json") ? OutputFormat::JSON : OutputFormat::CSV;
+		const size_t threadCount = (argc >= 5) ? std::strtoul(argv[4], nullptr, 10) : 0;
+		const std::string cacheDirectory = (argc >= 6) ? argv[5] : std::string();
+
+		return (OptimizeCars(carsPath, format, threadCount, cacheDirectory) == 0) ? 0 : 1;
+	}
+
+	// make sure we don't have too many args
+	if (argc > 3)
+	{
+		std::cout << "Usage: " << argv[0] << " [dataFile:string:data.acd] [directory:string:wd]\n";
+		std::cout << "       " << argv[0] << " --batch [carsDirectory:string:wd] [format:csv|json:csv] [threads:int:hw] [cacheDirectory:string[OPT]]\n";
+		std::cout << "       " << argv[0] << " --gearing [dataFile:string:data.acd] [directory:string:wd] [ratios:min,max,step:0.5,4,0.05] [finals:min,max,step:2.5,5,0.25] [speeds:min,max:0,250] [count:int:5] [threads:int:hw]\n";
+		std::cout << Framework::Diagnostics::GetUsage() << '\n';
 		return 1;
 	}
 
-	const auto redlineTorqueBase = torqueCurve.GetValue(redline);
+	std::string dataFile = (argc >= 2) ? argv[1] : "data.acd";
+	std::string directory = (argc >= 3) ? argv[2] : GetWorkingDirectory();
+
+	ShiftTable table;
+	std::string error;
 
-	for (size_t i = 0; i < (gearRatios.first.size() - 1); ++i)
+	if (OptimizeCar(dataFile, directory, nullptr, table, error) == false)
 	{
-		// figure out if we should go to redline
-		const auto currRatio = gearRatios.first[i];
-		const auto nextRatio = gearRatios.first[i + 1];
+		std::cout << error << '\n';
+		return 1;
+	}
 
-		auto nextGearRPM = redline * (nextRatio / currRatio);
-		const auto nextGearTorqueBase = torqueCurve.GetValue(static_cast<Curve::Data_t>(nextGearRPM));
+	for (size_t i = 0; i < table.shiftPoints.size(); ++i)
+	{
+		const auto shiftRPM = table.shiftPoints[i];
 
-		const auto redlineTorque = redlineTorqueBase * currRatio;
-		const auto nextGearTorque = nextGearTorqueBase * nextRatio;
+		// the next gear is always better
+		if (shiftRPM < 0.0)
+			continue;
 
-		if (redlineTorque > nextGearTorque)
+		if (shiftRPM >= table.redline)
 		{
 			// we should go to redline, torque is greater
 			std::cout << "Go to redline for gear " << i + 1 << '\n';
 			continue;
 		}
 
-		// we could use this if they were in the same interpolation range, 
-		// but that is near impossible https://goodaids.club/i/3c1ay529tm.png
-		// so lets take a naive approach and work backwards from redline, 
-		// finding the first place that the current gear would produce more torque, 
-		// which is the optimal shift point
-		for (int32_t rpm = redline; rpm > 0; --rpm)
-		{
-			// get the current torque, and the torque at the RPM of our next gear
-			const auto currTorqueBase = torqueCurve.GetValue(rpm);
-			nextGearRPM = rpm * (nextRatio / currRatio);
-			const auto nextTorqueBase = torqueCurve.GetValue(static_cast<Curve::Data_t>(nextGearRPM));
+		// above this point, acceleration would be greater in the higher gear
+		std::cout << "Shift before " << std::fixed << std::setprecision(1) << shiftRPM << " rpm from gear " << i + 1 << " to gear " << i + 2 << '\n';
+	}
 
-			// by finding where current torque exceeds next torque (because we are working backwards),
-			// we know where to shift at the highest RPM to get the best results.
-			const auto currTorque = currTorqueBase * currRatio;
-			const auto nextTorque = nextTorqueBase * nextRatio;
+	return 0;
+}
 
-			if (currTorque > nextTorque)
-			{
-				// rpm + 1 because that is where acceleration would be greater in a higher gear
-				std::cout << "Shift before " << rpm + 1 << " rpm from gear " << i + 1 << " to gear " << i + 2 << '\n';
-				break;
-			}
-		}
+int main(int argc, char* argv[])
+{
+	// --stats and --trace can go anywhere, the other arguments keep their order
+	std::vector<char*> args(argv, argv + argc);
+
+	ErrorCode ec;
+	const Framework::Diagnostics diagnostics(args, ec);
+
+	if (ec != Framework::ErrorCode_SUCCESS)
+	{
+		std::cout << "--trace needs a file to write the trace to\n";
+		return 1;
 	}
 
-	return 0;
+	const auto result = Run(static_cast<int>(args.size()), args.data());
+
+	// on stderr, so it never mixes with the output
+	diagnostics.Report(std::cerr);
+
+	return result;
 }
\ No newline at end of file
@@ -0,0 +1,69 @@
+#ifndef FRAMEWORK_ACCELERATIONSIMULATOR_H_
+#define FRAMEWORK_ACCELERATIONSIMULATOR_H_
+
+/*
+ *	Acceleration Simulator
+ *	10/17/26 22:30
+ */
+
+#include <Framework/Car.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace Framework
+{
+	/*
+	 *	AccelerationSimulator runs a car from standstill in fixed
+	 *	time steps. The wheel force of every gear is tabulated up front
+	 *	by speed, as acceleration, so a step is one table lookup.
+	 *	The clutch slips until the engine reaches the torque curve,
+	 *	and tyre grip and rolling resistance are not modelled
+	 */
+	class AccelerationSimulator
+	{
+	public:
+		// the rpm to shift up at in each gear, first gear first
+		using ShiftPoints_t = std::vector<float>;
+
+		struct Times
+		{
+			// seconds from standstill, negative if the speed was not reached
+			double time100 = -1.0;
+			double time200 = -1.0;
+		};
+
+		// tabulates the wheel force of every gear. timeStep is in seconds
+		explicit AccelerationSimulator(const Car& car, double timeStep = 0.001);
+
+		// accelerates from standstill to 200 km/h, shifting up at shiftPoints. missing shift points are at redline
+		Times Run(const ShiftPoints_t& shiftPoints) const;
+		// searches for the shift points that reach 200 km/h soonest, or 100 km/h if the car cannot reach 200.
+		// the shift points are stored in shiftPoints
+		Times Optimize(ShiftPoints_t& shiftPoints) const;
+
+		// returns the number of forward gears
+		size_t GetGearCount() const noexcept;
+	private:
+		// runs the simulation, giving up once timeLimit seconds have passed
+		Times Simulate(const ShiftPoints_t& shiftPoints, double timeLimit) const;
+		// returns the acceleration in m/s^2 from the wheel force of gear at speed in m/s, before drag
+		double GetAcceleration(size_t gear, double speed) const noexcept;
+
+		double m_timeStep;
+		// deceleration from drag in m/s^2 is this times speed squared
+		double m_dragFactor;
+		double m_shiftTime;
+		int32_t m_redline;
+
+		// engine rpm per m/s in each gear
+		std::vector<double> m_rpmPerSpeed;
+
+		// m_accelerations[gear * m_bins + bin] is the acceleration from gear at bin * TABLE_STEP m/s, 0 beyond redline
+		size_t m_bins;
+		std::vector<float> m_accelerations;
+	};
+}
+
+#endif
\ No newline at end of file
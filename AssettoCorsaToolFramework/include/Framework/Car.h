@@ -0,0 +1,82 @@
+#ifndef FRAMEWORK_CAR_H_
+#define FRAMEWORK_CAR_H_
+
+/*
+ *	Car
+ *	10/17/26 22:10
+ */
+
+#include <Framework/Curve.h>
+#include <Framework/Error.h>
+#include <Framework/Files/FileManager.h>
+
+#include <cstdint>
+#include <vector>
+
+namespace Framework
+{
+	/*
+	 *	Car holds the data that decides how a car accelerates, read
+	 *	from power.lut, engine.ini, drivetrain.ini, tyres.ini, car.ini
+	 *	and aero.ini in its archive. Only the parts that are asked for
+	 *	are read, the others stay 0. Everything is in SI units
+	 */
+	class Car
+	{
+	public:
+		using Ratios_t = std::vector<float>;
+
+		typedef enum PART
+		{
+			PART_ENGINE = (1 << 0),								// the torque curve and redline, from power.lut and engine.ini
+			PART_GEARBOX = (1 << 1),							// the gear ratios, final drive and shift time, from drivetrain.ini
+			PART_BODY = (1 << 2),								// the driven tyres, mass and drag, from drivetrain.ini, tyres.ini, car.ini and aero.ini
+			PART_ALL = PART_ENGINE | PART_GEARBOX | PART_BODY,	// everything, which AccelerationSimulator needs
+		} Part_t;
+
+		// combines part flags without leaving the enumeration
+		friend constexpr Part_t operator|(Part_t lhs, Part_t rhs) noexcept
+		{
+			return static_cast<Part_t>(static_cast<int>(lhs) | static_cast<int>(rhs));
+		}
+
+		// reads parts of the car from its archive. throws ErrorCode on error
+		explicit Car(const Files::FileManager& manager, Part_t parts = PART_ALL);
+		// reads parts of the car from its archive. stores ErrorCode in ec on error
+		Car(const Files::FileManager& manager, ErrorCode& ec, Part_t parts = PART_ALL) noexcept;
+
+		// returns the engine torque in Nm by rpm
+		const FloatCurve& GetTorqueCurve() const noexcept;
+		// returns the rpm of the rev limiter
+		int32_t GetRedline() const noexcept;
+		// returns the forward gear ratios, first gear first
+		const Ratios_t& GetGearRatios() const noexcept;
+		// returns the final drive ratio
+		float GetFinalRatio() const noexcept;
+		// returns the radius of the driven tyres in m
+		float GetTyreRadius() const noexcept;
+		// returns the total mass in kg
+		float GetMass() const noexcept;
+		// returns the drag coefficient times the area of every wing in m^2, 0 without aero.ini
+		float GetDragArea() const noexcept;
+		// returns how long an upshift takes in s, 0 if drivetrain.ini has no CHANGE_UP_TIME
+		float GetShiftTime() const noexcept;
+
+		// replaces the gearing, such as to try a different setup
+		void SetGearing(Ratios_t gearRatios, float finalRatio);
+	private:
+		// reads every value of parts, throws ErrorCode on error
+		void Load(const Files::FileManager& manager, Part_t parts);
+
+		FloatCurve m_torqueCurve;
+		int32_t m_redline = 0;
+		Ratios_t m_gearRatios;
+		float m_finalRatio = 0.f;
+		float m_tyreRadius = 0.f;
+		float m_mass = 0.f;
+		float m_dragArea = 0.f;
+		float m_shiftTime = 0.f;
+	};
+}
+
+#endif
\ No newline at end of file
@@ -8,44 +8,114 @@
 
 #include <Framework/Error.h>
 
+#include <cstddef>
 #include <cstdint>
 #include <istream>
-#include <map>
 #include <string>
+#include <string_view>
+#include <vector>
 
 namespace Framework
 {
 	/*
-	 *	Curve is an interpolated curve that receives curve data from
+	 *	BasicCurve is an interpolated curve that receives curve data from
 	 *	a LUT file. It functions in the same way as Kunos' curve, except
-	 *	with a different API
+	 *	with a different API. References and values are kept in two
+	 *	sorted arrays, so a lookup is a binary search over contiguous memory.
+	 *	Integer values interpolate through float and truncate, like the
+	 *	game does, floating point values interpolate in their own precision
 	 */
-	class Curve
+	template <typename RefType, typename ValueType>
+	class BasicCurve
 	{
 	public:
 		// no explicit constructor necessary
-		using Data_t = int32_t;
-		using Map_t = std::map<Data_t, Data_t>;
+		using Ref_t = RefType;
+		using Value_t = ValueType;
+		using RefArray_t = std::vector<Ref_t>;
+		using ValueArray_t = std::vector<Value_t>;
+		// what Curve used for both references and values before it took two types, kept so that code still compiles
+		using Data_t = Value_t;
 
+		// what every curve of any type in the process has done while Framework::Stats is enabled
+		struct Stats_t
+		{
+			uint64_t lutPoints;
+			uint64_t evaluations;
+		};
+
+		// which points ParseLUT keeps
+		typedef enum PARSE
+		{
+			PARSE_POSITIVE,	// points with a negative reference or value are skipped, such as for engine curves
+			PARSE_ALL,		// every point is kept, such as for drag by angle of attack, which goes below 0
+		} Parse_t;
+
+		// parses the LUT file in place, without allocating per line. lines without a reference and value are skipped,
+		// and anything after ';' or '#' is a comment. throws ErrorCode on error
+		void ParseLUT(std::string_view lutFile, Parse_t parse = PARSE_POSITIVE);
+		// parses the LUT file in place, without allocating per line. returns ErrorCode in ec on error
+		void ParseLUT(std::string_view lutFile, ErrorCode& ec, Parse_t parse = PARSE_POSITIVE);
 		// parses the LUT file via a stream. throws ErrorCode on error
-		void ParseLUT(std::istream& lutFile);
+		void ParseLUT(std::istream& lutFile, Parse_t parse = PARSE_POSITIVE);
 		// parses the LUT file via a stream. returns ErrorCode in ec on error
-		void ParseLUT(std::istream& lutFile, ErrorCode& ec);
+		void ParseLUT(std::istream& lutFile, ErrorCode& ec, Parse_t parse = PARSE_POSITIVE);
 
 		// returns the min reference
-		Data_t GetMinRef() const;
+		Ref_t GetMinRef() const;
 		// returns the max reference
-		Data_t GetMaxRef() const;
+		Ref_t GetMaxRef() const;
 
 		// returns the interpolated value at a point. returns 0 if the ref is out of range
-		Data_t GetValue(const Data_t ref) const;
+		Value_t GetValue(const Ref_t ref) const;
+		// writes the value at each of count refs to values, the same as calling GetValue for each.
+		// ascending refs are evaluated in one pass over the curve, a segment at a time with vector instructions
+		void GetValue(const Ref_t* refs, Value_t* values, size_t count) const;
+
+		// resamples the curve onto a uniform grid of step references, so GetValue is one index and one interpolation.
+		// a step of 1 is exact for integer references. otherwise a value can be off by step / 4 times the change in slope
+		// at each breakpoint within its grid cell, plus 2 for integer truncation. parsing more points returns to exact lookups
+		void Resample(const Ref_t step);
+		// returns the step of the grid, 0 if the curve is not resampled
+		Ref_t GetStep() const noexcept;
+
+		// returns the references in ascending order
+		const RefArray_t& GetRefs() const noexcept;
+		// returns the values, in the same order as the references
+		const ValueArray_t& GetValues() const noexcept;
 
-		// returns the list of values
-		const Map_t& GetValues() const noexcept;
+		// returns the counters of every curve of any type in the process
+		static Stats_t GetStats() noexcept;
 	private:
-		// need order for interpolation, it makes it easier
-		Map_t m_values;
+		// adds a point, unless its reference is already present
+		void AddPoint(const Ref_t ref, const Value_t value);
+		// looks up a value by searching the points
+		Value_t GetExactValue(const Ref_t ref) const;
+		// looks up a value in the grid
+		Value_t GetGridValue(const Ref_t ref) const;
+		// evaluates ascending refs by walking the points alongside them
+		void GetSortedValues(const Ref_t* refs, Value_t* values, size_t count) const;
+
+		// need order for interpolation, it makes it easier. m_values[i] belongs to m_refs[i]
+		RefArray_t m_refs;
+		ValueArray_t m_values;
+
+		// m_grid[i] is the value at GetMinRef() + i * m_step, and the last one is the value at GetMaxRef()
+		Ref_t m_step = 0;
+		ValueArray_t m_grid;
 	};
+
+	// the curve the game uses for whole number LUTs
+	using Curve = BasicCurve<int32_t, int32_t>;
+	// whole references with fractional values, such as torque by rpm
+	using FloatCurve = BasicCurve<int32_t, float>;
+	// fractional references and values
+	using DoubleCurve = BasicCurve<double, double>;
+
+	// these are the only instantiations, they are compiled once in Curve.cpp
+	extern template class BasicCurve<int32_t, int32_t>;
+	extern template class BasicCurve<int32_t, float>;
+	extern template class BasicCurve<double, double>;
 }
 
 #endif
\ No newline at end of file
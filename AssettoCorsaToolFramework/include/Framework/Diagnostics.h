@@ -0,0 +1,46 @@
+#ifndef FRAMEWORK_DIAGNOSTICS_H_
+#define FRAMEWORK_DIAGNOSTICS_H_
+
+/*
+ *	Diagnostics
+ *	10/18/26 05:10
+ */
+
+#include <Framework/Error.h>
+
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+namespace Framework
+{
+	/*
+	 *	Diagnostics handles the --stats and --trace [file] arguments
+	 *	every tool takes. They can go anywhere after the program name,
+	 *	are taken out of the arguments, and turn on Stats and Trace
+	 *	until the run is reported
+	 */
+	class Diagnostics
+	{
+	public:
+		// takes --stats and --trace [file] out of args, whose first argument is the program, and enables what they ask
+		// for. the other arguments keep their order. throws ErrorCode_FORMAT if --trace has no file
+		explicit Diagnostics(std::vector<char*>& args);
+		// takes --stats and --trace [file] out of args. stores ErrorCode_FORMAT in ec if --trace has no file
+		Diagnostics(std::vector<char*>& args, ErrorCode& ec) noexcept;
+
+		// prints the counters to out if --stats was given, and writes the trace if --trace was. a trace that cannot be
+		// written is reported to out
+		void Report(std::ostream& out) const;
+
+		// returns the line of usage that explains --stats and --trace
+		static const char* GetUsage() noexcept;
+	private:
+		void Parse(std::vector<char*>& args);
+
+		bool m_stats = false;
+		std::string m_traceFile;
+	};
+}
+
+#endif
\ No newline at end of file
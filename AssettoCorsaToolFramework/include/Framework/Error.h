@@ -6,8 +6,6 @@
  *	9/8/19 20:30
  */
 
-#include <string>
-
 namespace Framework
 {
 	enum _ErrorCode
@@ -17,12 +15,15 @@ namespace Framework
 		ErrorCode_FILENOTOPEN,	// a file is not open
 		ErrorCode_FORMAT,		// file had an invalid format
 		ErrorCode_EOF,			// end of file was reached	
+		ErrorCode_MODE,			// operation is not supported by the current mode
+		ErrorCode_DEADLOCK,		// operation would wait on itself forever
 	};
 
 	/*
 	 *	ErrorCode provides an abstraction which can
 	 *	be used to compare as an enumeration, containing
-	 *	a lower level _ErrorCode underneath
+	 *	a lower level _ErrorCode underneath. Messages are
+	 *	static, so making and copying one never allocates
 	 */
 	class ErrorCode
 	{
@@ -30,20 +31,19 @@ namespace Framework
 		using RawCode_t = _ErrorCode;
 
 		// constructs an empty ErrorCode
-		ErrorCode();
+		ErrorCode() noexcept;
 		// constructs with a raw _ErrorCode
-		ErrorCode(RawCode_t code);
+		ErrorCode(RawCode_t code) noexcept;
 
 		// get the raw error code
-		RawCode_t GetRawCode() const;
-		// get a message representing the error code
-		std::string GetMessage() const;
+		RawCode_t GetRawCode() const noexcept;
+		// get a message representing the error code, which lives as long as the program
+		const char* GetMessage() const noexcept;
 
 		// implicit conversion to the raw error
-		operator RawCode_t() const;
+		operator RawCode_t() const noexcept;
 	private:
 		RawCode_t m_code;
-		std::string m_message;
 	};
 }
 
@@ -0,0 +1,79 @@
+#ifndef FRAMEWORK_FILES_ARCHIVECACHE_H_
+#define FRAMEWORK_FILES_ARCHIVECACHE_H_
+
+/*
+ *	Archive Cache
+ *	10/17/26 23:55
+ */
+
+#include <Framework/Error.h>
+#include <Framework/Files/File.h>
+#include <Framework/Files/MappedFile.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace Framework
+{
+	namespace Files
+	{
+		/*
+		 *	ArchiveCache keeps decrypted images of archives in a directory
+		 *	on disk. An image holds the table of contents and the decrypted
+		 *	contents of the files that were stored, and is mapped and used in
+		 *	place. Files whose contents were not stored are left to be read
+		 *	from the archive. An image is only used while the archive has the
+		 *	size, modification time and sampled hash it had when it was stored
+		 */
+		class ArchiveCache
+		{
+		public:
+			using Key_t = std::string;
+
+			// a file in an image, as views into the mapping
+			struct Entry
+			{
+				File::View_t name;
+				File::View_t contents;
+				// whether the contents are in the image. if not, contents is empty
+				bool stored;
+			};
+
+			using Entries_t = std::vector<Entry>;
+
+			// uses directory for images, and creates it if it does not exist. throws ErrorCode on error
+			explicit ArchiveCache(std::string directory);
+			// uses directory for images, and creates it if it does not exist. stores ErrorCode in ec on error
+			ArchiveCache(std::string directory, ErrorCode& ec) noexcept;
+
+			// maps the image of the archive at fileName decrypted with key, and fills entries with its files in archive order.
+			// returns nullptr if there is no image, or the archive changed since it was stored. only throws std::bad_alloc
+			std::shared_ptr<const MappedFile> Find(const std::string& fileName, const Key_t& key, Entries_t& entries) const;
+
+			// stores an image of the files of the archive at fileName decrypted with key, replacing any earlier one. throws ErrorCode on error
+			void Store(const std::string& fileName, const Key_t& key, const std::vector<File>& files) const;
+			// stores an image of the files of the archive at fileName decrypted with key, replacing any earlier one. stores ErrorCode in ec on error
+			void Store(const std::string& fileName, const Key_t& key, const std::vector<File>& files, ErrorCode& ec) const noexcept;
+			// stores an image of the files of the archive at fileName decrypted with key, replacing any earlier one. only the contents of
+			// files marked in stored are kept, the others only have their names. throws ErrorCode on error
+			void Store(const std::string& fileName, const Key_t& key, const std::vector<File>& files, const std::vector<bool>& stored) const;
+			// stores an image of the files of the archive at fileName decrypted with key, replacing any earlier one. only the contents of
+			// files marked in stored are kept, the others only have their names. stores ErrorCode in ec on error
+			void Store(const std::string& fileName, const Key_t& key, const std::vector<File>& files, const std::vector<bool>& stored, ErrorCode& ec) const noexcept;
+
+			const std::string& GetDirectory() const noexcept;
+		private:
+			// create the directory, throws ErrorCode on error
+			void Create();
+			// returns the path of the image of an archive decrypted with key
+			std::string GetImagePath(const std::string& fileName, const Key_t& key) const;
+			// delete the old images of path that were moved aside while mapped, where nothing maps them anymore
+			void RemoveStale(const std::string& path) const noexcept;
+
+			std::string m_directory;
+		};
+	}
+}
+
+#endif
\ No newline at end of file
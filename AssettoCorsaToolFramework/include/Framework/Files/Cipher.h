@@ -0,0 +1,44 @@
+#ifndef FRAMEWORK_FILES_CIPHER_H_
+#define FRAMEWORK_FILES_CIPHER_H_
+
+/*
+ *	Cipher
+ *	10/17/26 16:40
+ */
+
+#include <cstddef>
+#include <string>
+
+namespace Framework
+{
+	namespace Files
+	{
+		/*
+		 *	Cipher applies the .acd key to and from raw contents. Each byte is
+		 *	stored as a 32-bit integer, offset by the repeating key. The
+		 *	widest kernel the processor supports is selected at runtime
+		 */
+		class Cipher
+		{
+		public:
+			using Key_t = std::string;
+
+			// constructs a cipher with an empty key, which leaves contents untouched
+			Cipher() : Cipher(Key_t()) {}
+			// constructs a cipher and expands the key for use in wide lanes
+			explicit Cipher(const Key_t& key);
+
+			// decrypts count 32-bit integers at raw into count bytes at out. raw does not need to be aligned.
+			// position is the offset of the first byte within its file, for decrypting a file in pieces
+			void Decrypt(const char* raw, char* out, size_t count, size_t position = 0) const noexcept;
+			// encrypts count bytes at in into count 32-bit integers at raw, the reverse of Decrypt
+			void Encrypt(const char* in, char* raw, size_t count, size_t position = 0) const noexcept;
+		private:
+			size_t m_keySize;
+			// the key repeated so that any window of one full vector width can be loaded from any key position
+			std::string m_keyStream;
+		};
+	}
+}
+
+#endif
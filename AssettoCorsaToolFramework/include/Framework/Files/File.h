@@ -6,31 +6,51 @@
  *	9/8/19 21:21
  */
 
+#include <memory>
 #include <string>
+#include <string_view>
 
 namespace Framework
 {
 	namespace Files
 	{
 		/*
-		 *	File is a class that holds a file's name and contents
+		 *	File is a class that holds a file's name and contents. The
+		 *	contents live in a shared buffer, which may hold the contents of
+		 *	other files too, so copies of a File never copy the contents
 		 */
 		class File
 		{
 		public:
 			using Data_t = std::string;
+			using View_t = std::string_view;
+			// keeps the contents alive, such as a string or a mapping they are a view into
+			using Buffer_t = std::shared_ptr<const void>;
 
-			// constructor for a file, read-only once created
-			File(const Data_t& name, const Data_t& contents);
+			// constructor for a file, read-only once created. takes ownership of the contents
+			File(Data_t name, Data_t contents);
+			// constructor for a file whose contents are a view into a shared buffer
+			File(Data_t name, Buffer_t buffer, View_t contents) noexcept;
 
-			Data_t GetName() const noexcept;
+			File(const File& other) = default;
+			File(File&& other) noexcept = default;
+			File& operator=(const File& other) = default;
+			File& operator=(File&& other) noexcept = default;
+
+			const Data_t& GetName() const noexcept;
+			// returns a copy of the contents
 			Data_t GetContents() const noexcept;
+			// returns a view of the contents, valid as long as this file or a copy of it exists
+			View_t GetContentsView() const noexcept;
+			// returns what keeps the contents alive
+			const Buffer_t& GetBuffer() const noexcept;
 		private:
 			Data_t m_name;
-			Data_t m_contents;
+			Buffer_t m_buffer;
+			View_t m_contents;
 		};
 
 	}
 }
 
-#endif
\ No newline at end of file
+#endif
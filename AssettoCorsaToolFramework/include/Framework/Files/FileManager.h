@@ -7,9 +7,20 @@
  */
 
 #include <Framework/Error.h>
+#include <Framework/Files/ArchiveCache.h>
+#include <Framework/Files/Cipher.h>
 #include <Framework/Files/File.h>
+#include <Framework/Files/MappedFile.h>
+#include <Framework/Result.h>
 
+#include <cstdint>
+#include <functional>
+#include <iosfwd>
+#include <memory>
+#include <mutex>
 #include <string>
+#include <string_view>
+#include <unordered_map>
 #include <vector>
 
 namespace Framework
@@ -26,36 +37,159 @@ namespace Framework
 		public:
 			using Key_t = std::string;
 			using Vec_t = std::vector<File>;
+			// receives a piece of a file. offset is where chunk starts in the file, and size is the size of the whole file
+			using Visitor_t = std::function<void(std::string_view name, File::View_t chunk, size_t offset, size_t size)>;
+			// receives a whole file, which it may keep
+			using FileVisitor_t = std::function<void(const File& file)>;
 
 			typedef enum MODE
 			{
 				MODE_READ = (1 << 0),						// read the file only, no encrypted output capabilites
 				MODE_WRITE = (1 << 1),						// write and encryption ability
 				MODE_READWRITE = MODE_READ | MODE_WRITE,	// read and write ability
+				MODE_MAP = (1 << 2),						// map the archive into memory and decrypt straight out of the mapping, used with MODE_READ
+				MODE_LAZY = (1 << 3),						// only read the table of contents, and decrypt each file the first time it is requested. implies MODE_MAP
 			} Mode_t;
 
-			// Default constructor, throws ErrorCode on error. Assumes directory only includes the name of the directory, and no other part of the path
-			FileManager(const std::string& fileName, const std::string& directory, Mode_t mode);
+			// what every manager in the process has done while Framework::Stats is enabled
+			struct Stats_t
+			{
+				uint64_t bytesRead;
+				uint64_t entriesDecrypted;
+				uint64_t bytesDecrypted;
+				uint64_t decryptNanoseconds;
+				uint64_t lookups;
+				uint64_t lookupNanoseconds;
+			};
+
+			// combines mode flags without leaving the enumeration
+			friend constexpr Mode_t operator|(Mode_t lhs, Mode_t rhs) noexcept
+			{
+				return static_cast<Mode_t>(static_cast<int>(lhs) | static_cast<int>(rhs));
+			}
+
+			// Default constructor, throws ErrorCode on error. Assumes directory only includes the name of the directory, and no other part of the path.
+			// fileName is only read with MODE_READ. threadCount is the number of threads used to decrypt entries, 0 uses one per hardware thread.
+			// with a cache, an unchanged archive is read from its decrypted image instead, and any other archive is stored in the cache.
+			// with MODE_LAZY, only the files that were loaded are stored, when the manager is destroyed, so the cache must outlive it
+			FileManager(const std::string& fileName, const std::string& directory, Mode_t mode, size_t threadCount = 1, const ArchiveCache* cache = nullptr);
 			// Overload that does not throw, stores ErrorCode in ec on error. Assumes directory only includes the name of the directory, and no other part of the path
-			FileManager(const std::string& fileName, const std::string& directory, Mode_t mode, ErrorCode& ec) noexcept;
+			FileManager(const std::string& fileName, const std::string& directory, Mode_t mode, ErrorCode& ec, size_t threadCount = 1, const ArchiveCache* cache = nullptr) noexcept;
+
+			FileManager(const FileManager&) = delete;
+			FileManager& operator=(const FileManager&) = delete;
+
+			// with MODE_LAZY and a cache, stores the files that were loaded since the archive was opened, unless files were added
+			~FileManager();
+
+			// Lookups and iteration can run on any number of threads at once, with MODE_LAZY too, as long as no file is added.
+			// A file requested by several threads at once may be decrypted more than once, but only one copy is kept
 
 			// Gets a single file by name. Throws ErrorCode on error
-			File GetFile(const std::string& fileName) const;
-			// Gets a single file by name. Stores ErrorCode in ec on error
-			File GetFile(const std::string& fileName, ErrorCode& ec) const noexcept;
+			const File& GetFile(std::string_view fileName) const;
+			// Gets a single file by name. Stores ErrorCode in ec on error, and returns an empty file
+			const File& GetFile(std::string_view fileName, ErrorCode& ec) const noexcept;
+			// Finds a single file by name. Returns nullptr if the file does not exist
+			const File* FindFile(std::string_view fileName) const noexcept;
+			// Gets a single file by name. The result holds ErrorCode_FILENOTFOUND if the file does not exist, nothing is thrown
+			Result<const File*> TryGetFile(std::string_view fileName) const noexcept;
+
+			// Gets all files without copying them. With MODE_LAZY this decrypts every file not yet requested
+			const Vec_t& GetFiles() const noexcept;
 
-			// Gets all files
-			Vec_t GetFiles() const noexcept;
+			// Iterates over all files without copying them. With MODE_LAZY this decrypts every file not yet requested
+			Vec_t::const_iterator begin() const noexcept;
+			Vec_t::const_iterator end() const noexcept;
+
+			// Passes every file to visitor in archive order. With MODE_LAZY, files that were not requested yet are decrypted
+			// into one reused buffer and never kept, so memory stays bounded. Files larger than chunkSize are passed in pieces
+			// of chunkSize bytes, 0 passes every file whole. Empty files are passed once with an empty chunk
+			void VisitFiles(const Visitor_t& visitor, size_t chunkSize = 0) const;
+			// Passes every file to visitor in archive order. With MODE_LAZY, files that were not requested yet are decrypted
+			// into their own buffer and never kept by the manager, so they only live as long as the visitor keeps them
+			void ForEachFile(const FileVisitor_t& visitor) const;
+
+			// Adds a file, replacing any file with the same name. Throws ErrorCode if the manager was not created with MODE_WRITE
+			void AddFile(File file);
+			// Adds a file, replacing any file with the same name. Stores ErrorCode in ec if the manager was not created with MODE_WRITE
+			void AddFile(File file, ErrorCode& ec) noexcept;
+			// Adds every file in another manager without copying their contents. Throws ErrorCode on error
+			void AddFiles(const FileManager& other);
+			// Adds every file in another manager without copying their contents. Stores ErrorCode in ec on error
+			void AddFiles(const FileManager& other, ErrorCode& ec) noexcept;
+			// Adds every regular file in a directory on disk, named by their file names. Throws ErrorCode on error
+			void AddDirectory(const std::string& path);
+			// Adds every regular file in a directory on disk, named by their file names. Stores ErrorCode in ec on error
+			void AddDirectory(const std::string& path, ErrorCode& ec) noexcept;
+
+			// Encrypts every file into an archive at fileName, which decrypts with this manager's directory. Throws ErrorCode on error
+			void WriteFiles(const std::string& fileName) const;
+			// Encrypts every file into an archive at fileName, which decrypts with this manager's directory. Stores ErrorCode in ec on error
+			void WriteFiles(const std::string& fileName, ErrorCode& ec) const noexcept;
+
+			// Returns the counters of every manager in the process. Times are summed over threads
+			static Stats_t GetStats() noexcept;
 		private:
+			// an entry in the archive's table of contents
+			struct Entry
+			{
+				std::string name;
+				size_t offset;	// offset of the encrypted contents in the mapping
+				size_t size;	// size of the decrypted contents
+			};
+
 			// calculate the decryption key
 			void CalculateKey(const std::string& directory);
-			// decrypt all of the files and populate m_files, used with MODE_READ
+			// read the archive from the cache if it can, or decrypt it and store it in the cache
+			void ReadFiles(const std::string& fileName);
+			// open the archive and decrypt it with the method selected by the mode
+			void DecryptArchive(const std::string& fileName);
+			// populate m_entries and m_files from the cached image of the archive. files that are not in the image are read from
+			// the archive, lazily with MODE_LAZY. returns false if there is no image
+			bool ReadImage(const std::string& fileName);
+			// store the files marked in stored in the cache, or every file if stored is nullptr. a failure is counted in
+			// Stats::COUNTER_CACHEFAILURES, and only means decrypting again next time
+			void StoreImage(const std::string& fileName, const std::vector<bool>* stored) noexcept;
+			// decrypt all of the files and populate m_entries and m_files, used with MODE_READ
 			void DecryptFiles(std::ifstream& fs);
+			// walk the name and size headers of m_mapping and populate m_entries, used with MODE_MAP
+			void ReadEntries();
+			// decrypt a single entry out of m_mapping into out, which holds entry.size bytes
+			void DecryptEntry(const Entry& entry, char* out) const;
+			// returns whether the file at index has been decrypted
+			bool IsLoaded(size_t index) const;
+			// make sure the file at index has been decrypted
+			void LoadFile(size_t index) const;
+			// decrypt every file that has not been decrypted yet into one shared buffer, across m_threadCount threads
+			void LoadFiles() const;
+			// add a file, replacing any file with the same name, once the mode has been checked
+			void InsertFile(File file);
+			// encrypt a single file into the archive stream
+			void EncryptFile(const File& file, std::ofstream& fileOut, std::vector<char>& raw) const;
+			// index every entry by name, once m_entries is complete
+			void BuildIndex();
 
 			Key_t m_key;
+			Cipher m_cipher;
 			Mode_t m_mode;
+			size_t m_threadCount;
+			const ArchiveCache* m_cache;
+			// the archive, and the number of files whose contents are in its cached image
+			std::string m_fileName;
+			size_t m_storedCount = 0;
+			// whether a file was added or replaced, which keeps the files from being stored as the archive's image
+			bool m_modified = false;
+
+			// only kept alive past the constructor with MODE_LAZY. files can only be loaded while it is alive
+			std::unique_ptr<MappedFile> m_mapping;
+			std::vector<Entry> m_entries;
+			// maps names in m_entries to their index, which is shared with m_files
+			std::unordered_map<std::string_view, size_t> m_index;
 
-			Vec_t m_files;
+			// files are placeholders until they are loaded. a loaded file never changes again, so only loading takes the lock
+			mutable Vec_t m_files;
+			mutable std::vector<bool> m_loaded;
+			mutable std::mutex m_loadMutex;
 		};
 	}
 }
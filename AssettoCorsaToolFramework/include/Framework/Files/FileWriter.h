@@ -0,0 +1,114 @@
+#ifndef FRAMEWORK_FILES_FILEWRITER_H_
+#define FRAMEWORK_FILES_FILEWRITER_H_
+
+/*
+ *	File Writer
+ *	10/17/26 20:10
+ */
+
+#include <Framework/Error.h>
+#include <Framework/Files/File.h>
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace Framework
+{
+	namespace Files
+	{
+		/*
+		 *	FileWriter writes files to disk on its own threads, so
+		 *	writing overlaps with decryption. Every file is preallocated
+		 *	and written in binary, whole or in pieces, and the queue of
+		 *	pending contents is bounded so memory stays bounded too
+		 */
+		class FileWriter
+		{
+		public:
+			// called on a writer thread once a file has been written, or failed to be
+			using Callback_t = std::function<void(const std::string& path, const ErrorCode& ec)>;
+
+			// starts threadCount writer threads. Write blocks while more than maxQueuedBytes of contents are waiting
+			explicit FileWriter(size_t threadCount = 1, size_t maxQueuedBytes = 64 * 1024 * 1024);
+
+			FileWriter(const FileWriter&) = delete;
+			FileWriter& operator=(const FileWriter&) = delete;
+
+			// waits for every queued write and joins the writer threads
+			~FileWriter();
+
+			// queues the file's contents to be written to path, creating its parent directories. the file's buffer is kept alive until then
+			void Write(std::string path, File file, Callback_t callback = nullptr);
+			// queues a piece of a file of size bytes to be written at offset into path. the piece is copied, so its buffer can be
+			// reused once this returns. the pieces of a file must be queued in order from offset 0, and may be written in any order.
+			// callback is taken from the first piece, and called once every piece has been written
+			void WriteChunk(std::string path, File::View_t chunk, size_t offset, size_t size, Callback_t callback = nullptr);
+			// waits for every queued write. returns the number of writes that failed since the last call
+			size_t Wait();
+		private:
+			// a file written in pieces, shared by the jobs of its pieces
+			struct Stream
+			{
+				Callback_t callback;
+				// the first piece to be written creates the file
+				std::once_flag created;
+				std::mutex mutex;
+				size_t remaining;	// bytes not written yet
+				ErrorCode ec;		// the first failure
+			};
+
+			struct Job
+			{
+				std::string path;
+				File file;
+				Callback_t callback;
+				// only set for pieces, which go at offset into a file of size bytes
+				std::shared_ptr<Stream> stream;
+				size_t offset;
+				size_t size;
+			};
+
+			// waits for room in the queue, and queues the job
+			void Queue(Job job);
+			// the loop each writer runs until the writer is destroyed
+			void WriterLoop();
+			// writes a job and calls its callback, then releases it
+			ErrorCode RunJob(Job job);
+			// writes a single job to disk
+			ErrorCode WriteJob(const Job& job);
+			// creates the parent directory of path, unless it was already created
+			bool CreateParent(const std::string& path);
+
+			std::vector<std::thread> m_writers;
+
+			std::mutex m_mutex;
+			std::condition_variable m_jobReady;
+			std::condition_variable m_spaceReady;
+			std::condition_variable m_jobsDone;
+			std::deque<Job> m_jobs;
+			size_t m_maxQueuedBytes;
+			size_t m_queuedBytes = 0;
+			size_t m_activeJobs = 0;
+			size_t m_failures = 0;
+			bool m_stopping = false;
+
+			// files whose last piece has not been queued yet, by path
+			std::unordered_map<std::string, std::shared_ptr<Stream>> m_streams;
+
+			// directories that exist already, so each one is only created once
+			std::mutex m_directoryMutex;
+			std::unordered_set<std::string> m_directories;
+		};
+	}
+}
+
+#endif
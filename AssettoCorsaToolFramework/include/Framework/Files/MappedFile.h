@@ -0,0 +1,58 @@
+#ifndef FRAMEWORK_FILES_MAPPEDFILE_H_
+#define FRAMEWORK_FILES_MAPPEDFILE_H_
+
+/*
+ *	Mapped File
+ *	10/17/26 14:05
+ */
+
+#include <Framework/Error.h>
+
+#include <cstddef>
+#include <string>
+
+namespace Framework
+{
+	namespace Files
+	{
+		/*
+		 *	MappedFile maps an entire file read-only into memory, so
+		 *	its contents can be read without any intermediate copies
+		 */
+		class MappedFile
+		{
+		public:
+			// maps the file into memory. throws ErrorCode on error
+			MappedFile(const std::string& fileName);
+			// maps the file into memory. stores ErrorCode in ec on error
+			MappedFile(const std::string& fileName, ErrorCode& ec) noexcept;
+
+			MappedFile(const MappedFile&) = delete;
+			MappedFile& operator=(const MappedFile&) = delete;
+
+			~MappedFile();
+
+			// returns the start of the mapping, nullptr if the file is empty
+			const char* GetData() const noexcept;
+			// returns the size of the mapping in bytes
+			size_t GetSize() const noexcept;
+		private:
+			// map the file, returns the error on failure
+			ErrorCode Map(const std::string& fileName) noexcept;
+			// unmap the file and close any handles
+			void Unmap() noexcept;
+
+			const char* m_data = nullptr;
+			size_t m_size = 0;
+
+#ifdef _WIN32
+			void* m_file = nullptr;
+			void* m_mapping = nullptr;
+#else
+			int m_file = -1;
+#endif
+		};
+	}
+}
+
+#endif
@@ -0,0 +1,103 @@
+#ifndef FRAMEWORK_GEARINGSEARCH_H_
+#define FRAMEWORK_GEARINGSEARCH_H_
+
+/*
+ *	Gearing Search
+ *	10/17/26 23:20
+ */
+
+#include <Framework/AccelerationSimulator.h>
+#include <Framework/Car.h>
+
+#include <atomic>
+#include <cstddef>
+#include <mutex>
+#include <vector>
+
+namespace Framework
+{
+	/*
+	 *	GearingSearch looks for the gear and final drive ratios that
+	 *	give a car the most wheel force across a speed range. Every
+	 *	gear takes a value from the same range and gears descend. The
+	 *	wheel force of every ratio is tabulated once, branches are
+	 *	searched in parallel, and a branch is pruned as soon as even
+	 *	the best of its remaining ratios cannot beat what was found
+	 */
+	class GearingSearch
+	{
+	public:
+		// candidate ratios are min, min + step, and so on up to max
+		struct Range
+		{
+			float min;
+			float max;
+			float step;
+		};
+
+		struct Candidate
+		{
+			Car::Ratios_t gearRatios;
+			float finalRatio = 0.f;
+			// the mean of the best wheel force of any gear across the speed range, in N
+			double averageForce = 0.0;
+			// filled in by Simulate
+			AccelerationSimulator::ShiftPoints_t shiftPoints;
+			AccelerationSimulator::Times times;
+		};
+
+		using Candidates_t = std::vector<Candidate>;
+
+		// tabulates the wheel force of every ratio in gearRange with every ratio in finalRange, between minSpeed
+		// and maxSpeed in km/h. the car keeps its number of gears. threadCount of 0 uses every hardware thread
+		GearingSearch(const Car& car, const Range& gearRange, const Range& finalRange, double minSpeed, double maxSpeed, size_t threadCount = 0);
+
+		// returns up to count gearings with the highest average wheel force, best first
+		Candidates_t Search(size_t count = 1) const;
+		// times every candidate from standstill with its best shift points, and sorts them by 0-200 km/h, best first
+		void Simulate(Candidates_t& candidates) const;
+	private:
+		// the best candidates so far, shared by every branch
+		struct Results
+		{
+			std::mutex mutex;
+			Candidates_t candidates;
+			size_t count;
+			// the average force a candidate has to beat to be kept
+			std::atomic<double> threshold;
+		};
+
+		// searches every gearing with the final ratio and first gear ratio at these indices
+		void SearchBranch(size_t finalIndex, size_t firstIndex, Results& results) const;
+		// chooses the ratio of gear depth, below the ratio of the gear before it
+		void SearchGear(size_t finalIndex, size_t depth, std::vector<float>& envelopes, std::vector<size_t>& indices, Results& results) const;
+		// keeps a gearing if it is among the best
+		void Offer(size_t finalIndex, const std::vector<size_t>& indices, double averageForce, Results& results) const;
+
+		// returns the wheel force of a ratio at every speed
+		const float* GetForces(size_t finalIndex, size_t ratioIndex) const noexcept;
+		// returns the best wheel force of a ratio or any smaller one at every speed
+		const float* GetBestForces(size_t finalIndex, size_t ratioIndex) const noexcept;
+		// returns how much a smaller ratio adds to the forces of a ratio, summed over every speed
+		float GetGain(size_t finalIndex, size_t ratioIndex, size_t smallerIndex) const noexcept;
+		// returns the sum of the gearCount largest gains of any smaller ratios over a ratio
+		float GetTopGains(size_t finalIndex, size_t ratioIndex, size_t gearCount) const noexcept;
+
+		Car m_car;
+		size_t m_threadCount;
+
+		// ascending
+		std::vector<float> m_gearValues;
+		std::vector<float> m_finalValues;
+
+		// indexed by final, then gear ratio, then speed
+		std::vector<float> m_forces;
+		std::vector<float> m_bestForces;
+		// indexed by final, then gear ratio, then smaller gear ratio
+		std::vector<float> m_gains;
+		// indexed by final, then gear ratio, then gear count
+		std::vector<float> m_topGains;
+	};
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,94 @@
+#ifndef FRAMEWORK_INI_H_
+#define FRAMEWORK_INI_H_
+
+/*
+ *	Ini
+ *	10/17/26 21:05
+ */
+
+#include <Framework/Error.h>
+#include <Framework/Result.h>
+
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+namespace Framework
+{
+	/*
+	 *	Ini indexes the sections and keys of an ini file as views into
+	 *	its contents, which must outlive it. Values end at the first
+	 *	whitespace or ';', and the first of a repeated key wins. Typed
+	 *	values are parsed in place with from_chars. The index itself is
+	 *	the one allocation of a parse, and none at all when an Ini is
+	 *	parsed again into the capacity it has. Lookups never allocate
+	 */
+	class Ini
+	{
+	public:
+		using View_t = std::string_view;
+
+		// constructs an empty index
+		Ini() = default;
+		// indexes contents
+		explicit Ini(View_t contents);
+
+		// indexes contents, replacing the current index. lines that are not a section or key are skipped
+		void Parse(View_t contents);
+
+		// returns whether the section has any keys
+		bool HasSection(View_t section) const noexcept;
+		// returns whether the section has the key
+		bool HasKey(View_t section, View_t key) const noexcept;
+
+		// returns the value of a key as T, which is View_t, an integer or floating point type.
+		// throws ErrorCode_FORMAT if the key is missing or its value is not a T
+		template <typename T>
+		T GetValue(View_t section, View_t key) const;
+		// returns the value of a key as T, which is View_t, an integer or floating point type.
+		// stores ErrorCode_FORMAT in ec and returns T() if the key is missing or its value is not a T
+		template <typename T>
+		T GetValue(View_t section, View_t key, ErrorCode& ec) const noexcept;
+		// returns the value of a key as T, which is View_t, an integer or floating point type.
+		// the result holds ErrorCode_FORMAT if the key is missing or its value is not a T, nothing is thrown
+		template <typename T>
+		Result<T> TryGetValue(View_t section, View_t key) const noexcept;
+	private:
+		struct Entry
+		{
+			View_t section;
+			View_t key;
+			View_t value;
+		};
+
+		// returns the entry for a key, nullptr if it is missing
+		const Entry* FindEntry(View_t section, View_t key) const noexcept;
+
+		// sorted by section, then key. repeated keys keep their file order
+		std::vector<Entry> m_entries;
+	};
+
+	// these are the only types values can be read as, they are compiled once in Ini.cpp
+	extern template Ini::View_t Ini::GetValue<Ini::View_t>(View_t, View_t) const;
+	extern template int32_t Ini::GetValue<int32_t>(View_t, View_t) const;
+	extern template uint32_t Ini::GetValue<uint32_t>(View_t, View_t) const;
+	extern template int64_t Ini::GetValue<int64_t>(View_t, View_t) const;
+	extern template float Ini::GetValue<float>(View_t, View_t) const;
+	extern template double Ini::GetValue<double>(View_t, View_t) const;
+
+	extern template Ini::View_t Ini::GetValue<Ini::View_t>(View_t, View_t, ErrorCode&) const noexcept;
+	extern template int32_t Ini::GetValue<int32_t>(View_t, View_t, ErrorCode&) const noexcept;
+	extern template uint32_t Ini::GetValue<uint32_t>(View_t, View_t, ErrorCode&) const noexcept;
+	extern template int64_t Ini::GetValue<int64_t>(View_t, View_t, ErrorCode&) const noexcept;
+	extern template float Ini::GetValue<float>(View_t, View_t, ErrorCode&) const noexcept;
+	extern template double Ini::GetValue<double>(View_t, View_t, ErrorCode&) const noexcept;
+
+	extern template Result<Ini::View_t> Ini::TryGetValue<Ini::View_t>(View_t, View_t) const noexcept;
+	extern template Result<int32_t> Ini::TryGetValue<int32_t>(View_t, View_t) const noexcept;
+	extern template Result<uint32_t> Ini::TryGetValue<uint32_t>(View_t, View_t) const noexcept;
+	extern template Result<int64_t> Ini::TryGetValue<int64_t>(View_t, View_t) const noexcept;
+	extern template Result<float> Ini::TryGetValue<float>(View_t, View_t) const noexcept;
+	extern template Result<double> Ini::TryGetValue<double>(View_t, View_t) const noexcept;
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,26 @@
+#ifndef FRAMEWORK_JSON_H_
+#define FRAMEWORK_JSON_H_
+
+/*
+ *	Json
+ *	10/18/26 05:10
+ */
+
+#include <string>
+#include <string_view>
+
+namespace Framework
+{
+	/*
+	 *	Json holds what the framework and tools share to write JSON,
+	 *	which is only ever written, never read
+	 */
+	class Json
+	{
+	public:
+		// returns text as the contents of a JSON string, with quotes, backslashes and control characters escaped
+		static std::string Escape(std::string_view text);
+	};
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,122 @@
+#ifndef FRAMEWORK_RESULT_H_
+#define FRAMEWORK_RESULT_H_
+
+/*
+ *	Result
+ *	10/18/26 03:10
+ */
+
+#include <Framework/Error.h>
+
+#include <optional>
+#include <type_traits>
+#include <utility>
+
+namespace Framework
+{
+	/*
+	 *	Result holds either a value or the ErrorCode of why
+	 *	there is none, so an operation can fail without throwing.
+	 *	An ErrorCode or raw _ErrorCode is always taken as the error,
+	 *	so neither can be the value
+	 */
+	template <typename T>
+	class Result
+	{
+	public:
+		using Value_t = T;
+
+		static_assert(std::is_same_v<std::decay_t<Value_t>, ErrorCode> == false && std::is_same_v<std::decay_t<Value_t>, ErrorCode::RawCode_t> == false,
+			"a Result can not tell an ErrorCode value from its error");
+
+		// constructs with a value
+		Result(Value_t value) noexcept(std::is_nothrow_move_constructible_v<Value_t>)
+			: m_value(std::move(value)) {}
+		// constructs with an error, which must not be ErrorCode_SUCCESS
+		Result(ErrorCode error) noexcept
+			: m_error(error) {}
+		// constructs with a raw error, so it is not promoted to an arithmetic value
+		Result(ErrorCode::RawCode_t error) noexcept
+			: m_error(error) {}
+
+		// returns whether there is a value
+		bool HasValue() const noexcept
+		{
+			return m_value.has_value();
+		}
+
+		// returns the value. throws the error if there is none
+		const Value_t& GetValue() const&
+		{
+			if (m_value.has_value() == false)
+				throw m_error;
+
+			return *m_value;
+		}
+		// returns the value. throws the error if there is none
+		Value_t&& GetValue() &&
+		{
+			if (m_value.has_value() == false)
+				throw m_error;
+
+			return std::move(*m_value);
+		}
+
+		// returns the value, or fallback if there is none
+		Value_t GetValueOr(Value_t fallback) const
+		{
+			return (m_value.has_value() == true) ? *m_value : std::move(fallback);
+		}
+
+		// returns the error, ErrorCode_SUCCESS if there is a value
+		ErrorCode GetError() const noexcept
+		{
+			return m_error;
+		}
+	private:
+		std::optional<Value_t> m_value;
+		ErrorCode m_error;
+	};
+
+	/*
+	 *	Result<void> holds only whether an operation succeeded
+	 */
+	template <>
+	class Result<void>
+	{
+	public:
+		using Value_t = void;
+
+		// constructs a success
+		Result() noexcept = default;
+		// constructs with an error, ErrorCode_SUCCESS is a success
+		Result(ErrorCode error) noexcept
+			: m_error(error) {}
+		// constructs with a raw error, ErrorCode_SUCCESS is a success
+		Result(ErrorCode::RawCode_t error) noexcept
+			: m_error(error) {}
+
+		// returns whether the operation succeeded
+		bool HasValue() const noexcept
+		{
+			return m_error == ErrorCode_SUCCESS;
+		}
+
+		// throws the error if the operation failed
+		void GetValue() const
+		{
+			if (m_error != ErrorCode_SUCCESS)
+				throw m_error;
+		}
+
+		// returns the error, ErrorCode_SUCCESS if the operation succeeded
+		ErrorCode GetError() const noexcept
+		{
+			return m_error;
+		}
+	private:
+		ErrorCode m_error;
+	};
+}
+
+#endif
\ No newline at end of file
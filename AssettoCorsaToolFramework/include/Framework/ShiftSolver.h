@@ -0,0 +1,42 @@
+#ifndef FRAMEWORK_SHIFTSOLVER_H_
+#define FRAMEWORK_SHIFTSOLVER_H_
+
+/*
+ *	Shift Solver
+ *	10/18/26 04:20
+ */
+
+#include <Framework/Car.h>
+
+#include <cstddef>
+#include <vector>
+
+namespace Framework
+{
+	/*
+	 *	ShiftSolver finds the shift points that keep a car at the highest
+	 *	wheel torque. Wheel torque in each gear is linear between the
+	 *	points of the torque curve, scaled by its ratio, so every shift
+	 *	point is solved exactly by walking those points down from redline
+	 */
+	class ShiftSolver
+	{
+	public:
+		// the rpm to shift up at from each gear to the next, first gear first. the redline means going to redline,
+		// and a negative one means the next gear is always better
+		using ShiftPoints_t = std::vector<double>;
+
+		// keeps a copy of the car, which needs Car::PART_ENGINE and Car::PART_GEARBOX
+		explicit ShiftSolver(const Car& car);
+
+		// solves the shift point from gear to the one after it, first gear is 0. returns redline if gear is better all
+		// the way, and false if the next gear is always better
+		bool Solve(size_t gear, double& shiftRPM) const;
+		// solves the shift point of every gear but the last
+		ShiftPoints_t Solve() const;
+	private:
+		Car m_car;
+	};
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,103 @@
+#ifndef FRAMEWORK_STATS_H_
+#define FRAMEWORK_STATS_H_
+
+/*
+ *	Stats
+ *	10/18/26 00:40
+ */
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <iosfwd>
+
+namespace Framework
+{
+	/*
+	 *	Stats counts what the framework does across the whole process.
+	 *	Every thread adds to its own block of counters, so counting never
+	 *	contends, and the blocks are summed when they are read. Nothing is
+	 *	counted or timed until counting is enabled, which leaves one
+	 *	relaxed load on every counted path
+	 */
+	class Stats
+	{
+	public:
+		typedef enum COUNTER
+		{
+			COUNTER_BYTESREAD,			// encrypted bytes read to decrypt contents, and bytes of contents read from cached images
+			COUNTER_ENTRIESDECRYPTED,	// archive entries decrypted
+			COUNTER_BYTESDECRYPTED,		// bytes of contents decrypted
+			COUNTER_DECRYPTTIME,		// ns spent decrypting, summed over threads
+			COUNTER_LOOKUPS,			// files looked up by name
+			COUNTER_LOOKUPTIME,			// ns spent looking files up, summed over threads
+			COUNTER_LUTPOINTS,			// LUT points parsed
+			COUNTER_CURVEEVALUATIONS,	// values looked up on curves
+			COUNTER_CACHEFAILURES,		// images that could not be stored in an ArchiveCache
+			COUNTER_COUNT,
+		} Counter_t;
+
+		using Values_t = std::array<uint64_t, COUNTER_COUNT>;
+
+		/*
+		 *	Timer adds the ns from its construction to its destruction
+		 *	to a counter, if counting was enabled when it was constructed
+		 */
+		class Timer
+		{
+		public:
+			explicit Timer(Counter_t counter) noexcept
+				: m_counter(counter), m_enabled(IsEnabled())
+			{
+				if (m_enabled == true)
+					m_start = std::chrono::steady_clock::now();
+			}
+
+			Timer(const Timer&) = delete;
+			Timer& operator=(const Timer&) = delete;
+
+			~Timer()
+			{
+				if (m_enabled == true)
+					AddEnabled(m_counter, static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - m_start).count()));
+			}
+		private:
+			Counter_t m_counter;
+			bool m_enabled;
+			std::chrono::steady_clock::time_point m_start;
+		};
+
+		// starts or stops counting in every thread
+		static void SetEnabled(bool enabled) noexcept;
+		// returns whether counting is enabled
+		static bool IsEnabled() noexcept
+		{
+			return s_enabled.load(std::memory_order_relaxed);
+		}
+
+		// adds value to a counter of the calling thread, if counting is enabled
+		static void Add(Counter_t counter, uint64_t value) noexcept
+		{
+			if (IsEnabled() == true)
+				AddEnabled(counter, value);
+		}
+
+		// returns every counter, summed over every thread that counted
+		static Values_t GetValues() noexcept;
+		// sets every counter to 0. counts added by other threads at the same time may survive
+		static void Reset() noexcept;
+
+		// returns a short name for a counter
+		static const char* GetName(Counter_t counter) noexcept;
+		// prints every counter, with the throughput and latencies derived from them. the formatting of out is left as it was
+		static void Print(std::ostream& out);
+	private:
+		// adds value to a counter of the calling thread
+		static void AddEnabled(Counter_t counter, uint64_t value) noexcept;
+
+		static std::atomic<bool> s_enabled;
+	};
+}
+
+#endif
\ No newline at end of file
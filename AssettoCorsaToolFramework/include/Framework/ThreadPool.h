@@ -0,0 +1,86 @@
+#ifndef FRAMEWORK_THREADPOOL_H_
+#define FRAMEWORK_THREADPOOL_H_
+
+/*
+ *	Thread Pool
+ *	10/17/26 17:20
+ */
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace Framework
+{
+	/*
+	 *	ThreadPool runs tasks on a fixed set of worker threads. Every
+	 *	worker has its own queue, and idle workers steal from the others,
+	 *	so a few long tasks do not hold up the rest. The first exception
+	 *	thrown by a task is rethrown by Wait
+	 */
+	class ThreadPool
+	{
+	public:
+		using Task_t = std::function<void()>;
+
+		// creates threadCount workers. 0 uses one worker per hardware thread
+		explicit ThreadPool(size_t threadCount = 0);
+
+		ThreadPool(const ThreadPool&) = delete;
+		ThreadPool& operator=(const ThreadPool&) = delete;
+
+		// waits for outstanding tasks and joins the workers
+		~ThreadPool();
+
+		// queues a task to run on a worker. tasks submitted from a worker go to its own queue
+		void Submit(Task_t task);
+		// waits until every submitted task has finished. rethrows the first exception thrown by a task. throws
+		// ErrorCode_DEADLOCK from a task on this pool, which would wait for itself
+		void Wait();
+
+		// runs func for every index in [0, count) across the workers and the calling thread, and waits for those
+		// alone. rethrows the first exception thrown by func. can be called from a task on this pool, which runs
+		// queued tasks while it waits
+		void ParallelFor(size_t count, const std::function<void(size_t)>& func);
+
+		// returns the number of workers
+		size_t GetThreadCount() const noexcept;
+	private:
+		// a worker's own queue. the owner takes from the back, thieves from the front
+		struct Queue
+		{
+			std::mutex mutex;
+			std::deque<Task_t> tasks;
+		};
+
+		// the loop each worker runs until the pool is destroyed
+		void WorkerLoop(size_t index);
+		// takes a task from the worker's own queue, or steals one. returns false if there are none
+		bool TakeTask(size_t index, Task_t& task);
+		// runs a taken task, keeping its exception for Wait
+		void RunTask(Task_t& task);
+
+		std::vector<std::unique_ptr<Queue>> m_queues;
+		std::vector<std::thread> m_workers;
+
+		std::atomic<size_t> m_queued;	// tasks waiting in a queue
+		std::atomic<size_t> m_pending;	// tasks submitted but not finished
+		std::atomic<size_t> m_nextQueue;	// where the next task from outside the pool goes
+
+		// only used to sleep and wake workers and waiters
+		std::mutex m_mutex;
+		std::condition_variable m_taskReady;
+		std::condition_variable m_tasksDone;
+		bool m_stopping = false;
+		std::exception_ptr m_error;
+	};
+}
+
+#endif
@@ -0,0 +1,86 @@
+#ifndef FRAMEWORK_TRACE_H_
+#define FRAMEWORK_TRACE_H_
+
+/*
+ *	Trace
+ *	10/18/26 01:30
+ */
+
+#include <Framework/Error.h>
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+namespace Framework
+{
+	/*
+	 *	Trace records timed spans of what the framework does, for a
+	 *	timeline of a run across threads. Every thread records into its
+	 *	own ring buffer without locking, and once a ring is full its
+	 *	oldest spans are overwritten. The spans are written out as
+	 *	Chrome trace JSON, which chrome://tracing and Perfetto open.
+	 *	Nothing is recorded until tracing is enabled
+	 */
+	class Trace
+	{
+	public:
+		// the spans kept per thread
+		static constexpr size_t RING_SIZE = 16384;
+		// the bytes of a span's detail that are kept, the rest is cut off
+		static constexpr size_t DETAIL_SIZE = 47;
+
+		/*
+		 *	Span records the time from its construction to its destruction
+		 *	on the calling thread, if tracing was enabled when it was
+		 *	constructed. name must outlive the trace, detail must outlive
+		 *	the span and is copied when it is recorded
+		 */
+		class Span
+		{
+		public:
+			explicit Span(const char* name, std::string_view detail = std::string_view()) noexcept
+				: m_name(name), m_detail(detail), m_start(IsEnabled() ? GetTime() : -1) {}
+
+			Span(const Span&) = delete;
+			Span& operator=(const Span&) = delete;
+
+			~Span()
+			{
+				if (m_start >= 0)
+					Record(m_name, m_detail, m_start, GetTime());
+			}
+		private:
+			const char* m_name;
+			std::string_view m_detail;
+			int64_t m_start;
+		};
+
+		// starts or stops recording in every thread
+		static void SetEnabled(bool enabled) noexcept;
+		// returns whether recording is enabled
+		static bool IsEnabled() noexcept
+		{
+			return s_enabled.load(std::memory_order_relaxed);
+		}
+
+		// writes every recorded span to fileName as Chrome trace JSON. threads may keep recording, spans they overwrite
+		// while they are written out are left out. throws ErrorCode on error
+		static void Write(const std::string& fileName);
+		// writes every recorded span to fileName as Chrome trace JSON. stores ErrorCode in ec on error
+		static void Write(const std::string& fileName, ErrorCode& ec) noexcept;
+		// drops every recorded span. spans recorded by other threads at the same time may survive
+		static void Clear() noexcept;
+	private:
+		// returns the ns since the trace started
+		static int64_t GetTime() noexcept;
+		// adds a span to the ring of the calling thread
+		static void Record(const char* name, std::string_view detail, int64_t start, int64_t end) noexcept;
+
+		static std::atomic<bool> s_enabled;
+	};
+}
+
+#endif
\ No newline at end of file
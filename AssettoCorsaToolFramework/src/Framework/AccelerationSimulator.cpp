@@ -0,0 +1,208 @@
+#include <Framework/AccelerationSimulator.h>
+
+#include <Framework/Trace.h>
+
+#include <algorithm>
+#include <cmath>
+
+using Framework::AccelerationSimulator;
+using Framework::Car;
+using Framework::Trace;
+
+namespace
+{
+	// the speed between two entries of the acceleration table, in m/s
+	constexpr double TABLE_STEP = 0.05;
+
+	constexpr double AIR_DENSITY = 1.225;
+	constexpr double PI = 3.14159265358979323846;
+
+	constexpr double SPEED_100 = 100.0 / 3.6;
+	constexpr double SPEED_200 = 200.0 / 3.6;
+
+	// a run gives up after this many seconds
+	constexpr double MAX_TIME = 120.0;
+
+	// the shift search tries every this many rpm
+	constexpr float SEARCH_STEP = 25.f;
+	// and looks this far below redline
+	constexpr float SEARCH_RANGE = 0.5f;
+}
+
+AccelerationSimulator::AccelerationSimulator(const Car& car, double timeStep)
+	: m_timeStep(timeStep), m_dragFactor(0.5 * AIR_DENSITY * car.GetDragArea() / car.GetMass()),
+	m_shiftTime(car.GetShiftTime()), m_redline(car.GetRedline())
+{
+	const auto& torqueCurve = car.GetTorqueCurve();
+	const auto& gearRatios = car.GetGearRatios();
+
+	// wheel revolutions per minute at 1 m/s
+	const auto wheelRPM = 60.0 / (2.0 * PI * car.GetTyreRadius());
+
+	for (const auto ratio : gearRatios)
+		m_rpmPerSpeed.push_back(wheelRPM * ratio * car.GetFinalRatio());
+
+	// the top gear at redline is the fastest the car can go, leave one entry past it for interpolation
+	m_bins = static_cast<size_t>(m_redline / m_rpmPerSpeed.back() / TABLE_STEP) + 2;
+	m_accelerations.resize(gearRatios.size() * m_bins);
+
+	std::vector<FloatCurve::Ref_t> rpms(m_bins);
+	std::vector<FloatCurve::Value_t> torques(m_bins);
+
+	for (size_t gear = 0; gear < gearRatios.size(); ++gear)
+	{
+		// the clutch slips until the engine reaches the curve, and the limiter cuts it at redline
+		for (size_t bin = 0; bin < m_bins; ++bin)
+			rpms[bin] = std::max(torqueCurve.GetMinRef(), static_cast<FloatCurve::Ref_t>(bin * TABLE_STEP * m_rpmPerSpeed[gear]));
+
+		// ascending, so this is one pass over the curve
+		torqueCurve.GetValue(rpms.data(), torques.data(), m_bins);
+
+		// stored as acceleration, so a step does not divide by the mass
+		const auto torqueToAcceleration = gearRatios[gear] * car.GetFinalRatio() / car.GetTyreRadius() / car.GetMass();
+
+		for (size_t bin = 0; bin < m_bins; ++bin)
+			m_accelerations[gear * m_bins + bin] = (rpms[bin] > m_redline) ? 0.f : static_cast<float>(torques[bin] * torqueToAcceleration);
+	}
+}
+
+AccelerationSimulator::Times AccelerationSimulator::Run(const ShiftPoints_t& shiftPoints) const
+{
+	return Simulate(shiftPoints, MAX_TIME);
+}
+
+AccelerationSimulator::Times AccelerationSimulator::Optimize(ShiftPoints_t& shiftPoints) const
+{
+	const Trace::Span span("optimize shift points");
+
+	// start by shifting at redline
+	shiftPoints.assign(GetGearCount() - 1, static_cast<float>(m_redline));
+
+	// lower is better. a car that cannot reach 200 km/h is judged by 100 km/h, after every car that can
+	const auto score = [](const Times& times)
+	{
+		if (times.time200 >= 0.0)
+			return times.time200;
+
+		if (times.time100 >= 0.0)
+			return MAX_TIME + times.time100;
+
+		return 2 * MAX_TIME;
+	};
+
+	auto best = Run(shiftPoints);
+
+	// improve one shift point at a time, with the others fixed, until none of them moves
+	for (auto improved = true; improved == true;)
+	{
+		improved = false;
+
+		for (size_t gear = 0; gear < shiftPoints.size(); ++gear)
+		{
+			auto candidates = shiftPoints;
+
+			for (auto rpm = static_cast<float>(m_redline); rpm >= m_redline * SEARCH_RANGE; rpm -= SEARCH_STEP)
+			{
+				candidates[gear] = rpm;
+
+				// a run slower than the best so far can stop early
+				const auto timeLimit = (best.time200 >= 0.0) ? best.time200 : MAX_TIME;
+				const auto result = Simulate(candidates, timeLimit);
+
+				if (score(result) < score(best))
+				{
+					best = result;
+					shiftPoints[gear] = rpm;
+					improved = true;
+				}
+			}
+		}
+	}
+
+	return best;
+}
+
+size_t AccelerationSimulator::GetGearCount() const noexcept
+{
+	return m_rpmPerSpeed.size();
+}
+
+AccelerationSimulator::Times AccelerationSimulator::Simulate(const ShiftPoints_t& shiftPoints, double timeLimit) const
+{
+	Times times;
+
+	double speed = 0.0;
+	double time = 0.0;
+	size_t gear = 0;
+	double shiftLeft = 0.0;
+
+	// upshifts only happen below the limiter, and only into gears that exist
+	const auto shiftSpeed = [&](size_t gear)
+	{
+		const auto rpm = (gear < shiftPoints.size()) ? std::min<double>(shiftPoints[gear], m_redline) : m_redline;
+		return rpm / m_rpmPerSpeed[gear];
+	};
+
+	auto nextShift = (GetGearCount() > 1) ? shiftSpeed(0) : HUGE_VAL;
+
+	while (time < timeLimit)
+	{
+		// no power reaches the wheels during a shift
+		const auto drive = (shiftLeft > 0.0) ? 0.0 : GetAcceleration(gear, speed);
+		const auto acceleration = drive - m_dragFactor * speed * speed;
+
+		if (acceleration <= 0.0 && shiftLeft <= 0.0)
+		{
+			// at top speed
+			if (gear + 1 == GetGearCount())
+				break;
+
+			// stuck on the limiter, shift up now
+			++gear;
+			shiftLeft = m_shiftTime;
+			nextShift = (gear + 1 < GetGearCount()) ? shiftSpeed(gear) : HUGE_VAL;
+			continue;
+		}
+
+		const auto nextSpeed = speed + acceleration * m_timeStep;
+
+		// the crossing is interpolated within the step
+		if (speed < SPEED_100 && nextSpeed >= SPEED_100)
+			times.time100 = time + m_timeStep * (SPEED_100 - speed) / (nextSpeed - speed);
+
+		if (speed < SPEED_200 && nextSpeed >= SPEED_200)
+		{
+			times.time200 = time + m_timeStep * (SPEED_200 - speed) / (nextSpeed - speed);
+			break;
+		}
+
+		speed = nextSpeed;
+		time += m_timeStep;
+		shiftLeft -= m_timeStep;
+
+		// shift up once the engine reaches the shift point
+		if (shiftLeft <= 0.0 && speed >= nextShift)
+		{
+			++gear;
+			shiftLeft = m_shiftTime;
+			nextShift = (gear + 1 < GetGearCount()) ? shiftSpeed(gear) : HUGE_VAL;
+		}
+	}
+
+	return times;
+}
+
+double AccelerationSimulator::GetAcceleration(size_t gear, double speed) const noexcept
+{
+	const auto position = speed * (1.0 / TABLE_STEP);
+	const auto bin = static_cast<size_t>(position);
+
+	// beyond the top gear's redline
+	if (bin + 1 >= m_bins)
+		return 0.0;
+
+	const auto* accelerations = m_accelerations.data() + gear * m_bins;
+	const auto frac = position - bin;
+
+	return accelerations[bin] + frac * (accelerations[bin + 1] - accelerations[bin]);
+}
@@ -0,0 +1,164 @@
+#include <Framework/Car.h>
+
+#include <Framework/Ini.h>
+#include <Framework/Trace.h>
+
+#include <string>
+#include <utility>
+
+using Framework::Car;
+using Framework::DoubleCurve;
+using Framework::ErrorCode;
+using Framework::FloatCurve;
+using Framework::Ini;
+using Framework::Trace;
+using Framework::Files::FileManager;
+
+Car::Car(const FileManager& manager, Part_t parts)
+{
+	Load(manager, parts);
+}
+
+Car::Car(const FileManager& manager, ErrorCode& ec, Part_t parts) noexcept
+{
+	try
+	{
+		Load(manager, parts);
+	}
+	catch (const ErrorCode& e)
+	{
+		ec = e;
+	}
+}
+
+const FloatCurve& Car::GetTorqueCurve() const noexcept
+{
+	return m_torqueCurve;
+}
+
+int32_t Car::GetRedline() const noexcept
+{
+	return m_redline;
+}
+
+const Car::Ratios_t& Car::GetGearRatios() const noexcept
+{
+	return m_gearRatios;
+}
+
+float Car::GetFinalRatio() const noexcept
+{
+	return m_finalRatio;
+}
+
+float Car::GetTyreRadius() const noexcept
+{
+	return m_tyreRadius;
+}
+
+float Car::GetMass() const noexcept
+{
+	return m_mass;
+}
+
+float Car::GetDragArea() const noexcept
+{
+	return m_dragArea;
+}
+
+float Car::GetShiftTime() const noexcept
+{
+	return m_shiftTime;
+}
+
+void Car::SetGearing(Ratios_t gearRatios, float finalRatio)
+{
+	m_gearRatios = std::move(gearRatios);
+	m_finalRatio = finalRatio;
+}
+
+void Car::Load(const FileManager& manager, Part_t parts)
+{
+	const Trace::Span span("read car");
+
+	// the engine
+	if (parts & PART_ENGINE)
+	{
+		m_torqueCurve.ParseLUT(manager.GetFile("power.lut").GetContentsView());
+
+		const Ini engine(manager.GetFile("engine.ini").GetContentsView());
+		m_redline = engine.GetValue<int32_t>("ENGINE_DATA", "LIMITER");
+
+		// the simulation and the shift points divide by these
+		if (m_torqueCurve.GetRefs().empty() == true || m_redline <= 0)
+			throw ErrorCode(ErrorCode_FORMAT);
+	}
+
+	if ((parts & (PART_GEARBOX | PART_BODY)) == 0)
+		return;
+
+	const Ini drivetrain(manager.GetFile("drivetrain.ini").GetContentsView());
+
+	// the gearbox
+	if (parts & PART_GEARBOX)
+	{
+		const auto gearCount = drivetrain.GetValue<int32_t>("GEARS", "COUNT");
+		if (gearCount <= 0)
+			throw ErrorCode(ErrorCode_FORMAT);
+
+		m_gearRatios.clear();
+		for (int32_t gear = 1; gear <= gearCount; ++gear)
+			m_gearRatios.push_back(drivetrain.GetValue<float>("GEARS", "GEAR_" + std::to_string(gear)));
+
+		m_finalRatio = drivetrain.GetValue<float>("GEARS", "FINAL");
+		// only the simulator uses the shift time, so a car without one still loads and shifts instantly
+		m_shiftTime = drivetrain.TryGetValue<float>("GEARBOX", "CHANGE_UP_TIME").GetValueOr(0.f) / 1000.f;
+
+		if (m_finalRatio <= 0.f)
+			throw ErrorCode(ErrorCode_FORMAT);
+
+		for (const auto ratio : m_gearRatios)
+		{
+			if (ratio <= 0.f)
+				throw ErrorCode(ErrorCode_FORMAT);
+		}
+	}
+
+	if ((parts & PART_BODY) == 0)
+		return;
+
+	// only the driven tyres push the car
+	const auto frontDriven = drivetrain.HasKey("TRACTION", "TYPE") == true && drivetrain.GetValue<Ini::View_t>("TRACTION", "TYPE") == "FWD";
+
+	const Ini tyres(manager.GetFile("tyres.ini").GetContentsView());
+	m_tyreRadius = tyres.GetValue<float>(frontDriven ? "FRONT" : "REAR", "RADIUS");
+
+	const Ini car(manager.GetFile("car.ini").GetContentsView());
+	m_mass = car.GetValue<float>("BASIC", "TOTALMASS");
+
+	// every wing adds its drag at its angle, the body is usually the first one. without aero, there is no drag
+	m_dragArea = 0.f;
+	if (const auto aeroFile = manager.FindFile("aero.ini"))
+	{
+		const Ini aero(aeroFile->GetContentsView());
+
+		for (int32_t wing = 0; ; ++wing)
+		{
+			const auto section = "WING_" + std::to_string(wing);
+			if (aero.HasSection(section) == false)
+				break;
+
+			// wings run at negative angles too
+			DoubleCurve dragCurve;
+			dragCurve.ParseLUT(manager.GetFile(aero.GetValue<Ini::View_t>(section, "LUT_AOA_CD")).GetContentsView(), DoubleCurve::PARSE_ALL);
+
+			const auto gain = (aero.HasKey(section, "CD_GAIN") == true) ? aero.GetValue<double>(section, "CD_GAIN") : 1.0;
+			const auto area = aero.GetValue<double>(section, "CHORD") * aero.GetValue<double>(section, "SPAN");
+
+			m_dragArea += static_cast<float>(dragCurve.GetValue(aero.GetValue<double>(section, "ANGLE")) * gain * area);
+		}
+	}
+
+	if (m_tyreRadius <= 0.f || m_mass <= 0.f)
+		throw ErrorCode(ErrorCode_FORMAT);
+}
@@ -1,101 +1,410 @@
 #include <Framework/Curve.h>
 
-#include <sstream>
+#include <Framework/Stats.h>
+#include <Framework/Trace.h>
+#include "FromChars.h"
 
-using Framework::Curve;
+#include <algorithm>
+#include <cmath>
+#include <iterator>
+#include <type_traits>
+
+// sse2 is part of the x64 baseline, and the default for x86 builds
+#if defined(_M_X64) || defined(__x86_64__) || defined(__SSE2__) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define FRAMEWORK_CURVE_SSE2
+#include <emmintrin.h>
+#endif
+
+using Framework::BasicCurve;
 using Framework::ErrorCode;
+using Framework::Stats;
+using Framework::Trace;
+
+namespace
+{
+	// integer references are offset in 64 bits, the span of a curve can exceed the reference type
+	template <typename Ref_t>
+	using Offset_t = std::conditional_t<std::is_integral_v<Ref_t>, int64_t, Ref_t>;
+
+	// parses the number at the start of text, after any whitespace. like atoi, integers stop at the decimal point
+	// and anything after the number is ignored. returns false if there is no number
+	template <typename T>
+	bool ParseNumber(std::string_view text, T& number)
+	{
+		const auto start = text.find_first_not_of(" \t\r");
+		if (start == std::string_view::npos)
+			return false;
+
+		text.remove_prefix(start);
+
+		return Framework::FromChars(text, number).ec == std::errc();
+	}
+
+	// returns the index of the first reference greater than ref, or size if there is none.
+	// the loop always runs log2(size) times and picks its half without a branch, so it never mispredicts
+	template <typename Ref_t>
+	size_t UpperBound(const Ref_t* refs, size_t size, const Ref_t ref)
+	{
+		const auto* first = refs;
+
+		while (size > 1)
+		{
+			const auto half = size / 2;
+			first = (first[half - 1] <= ref) ? first + half : first;
+			size -= half;
+		}
+
+		return (first - refs) + ((size == 1 && *first <= ref) ? 1 : 0);
+	}
+
+	// interpolates between two points the same way GetValue does
+	template <typename Ref_t, typename Value_t>
+	Value_t Interpolate(const Ref_t ref, const Ref_t belowRef, const Ref_t aboveRef, const Value_t belowValue, const Value_t aboveValue)
+	{
+		if (ref == belowRef)
+			return belowValue;
+
+		if constexpr (std::is_integral_v<Value_t>)
+		{
+			// integer curves interpolate in float and truncate, like the game
+			auto frac = (ref - belowRef) / static_cast<float>(aboveRef - belowRef);
+			return static_cast<Value_t>((frac * (aboveValue - belowValue)) + belowValue);
+		}
+		else
+		{
+			const auto frac = static_cast<Value_t>(ref - belowRef) / static_cast<Value_t>(aboveRef - belowRef);
+			return belowValue + frac * (aboveValue - belowValue);
+		}
+	}
+
+	// interpolates count refs that all lie within [belowRef, aboveRef)
+	template <typename Ref_t, typename Value_t>
+	void InterpolateSegment(const Ref_t* refs, Value_t* values, size_t count, const Ref_t belowRef, const Ref_t aboveRef,
+		const Value_t belowValue, const Value_t aboveValue)
+	{
+		size_t i = 0;
+
+#ifdef FRAMEWORK_CURVE_SSE2
+		// the same float operations as Interpolate, four lanes at a time, so the results are identical
+		if constexpr (std::is_same_v<Ref_t, int32_t> && (std::is_same_v<Value_t, int32_t> || std::is_same_v<Value_t, float>))
+		{
+			const auto below = _mm_set1_epi32(belowRef);
+			const auto size = _mm_set1_ps(static_cast<float>(aboveRef - belowRef));
+			const auto rise = _mm_set1_ps(static_cast<float>(aboveValue - belowValue));
+			const auto base = _mm_set1_ps(static_cast<float>(belowValue));
+
+			for (; i + 4 <= count; i += 4)
+			{
+				const auto ref = _mm_loadu_si128(reinterpret_cast<const __m128i*>(refs + i));
+				const auto frac = _mm_div_ps(_mm_cvtepi32_ps(_mm_sub_epi32(ref, below)), size);
+
+				// a ref on the point takes its value as is
+				const auto onPoint = _mm_cmpeq_epi32(ref, below);
 
-void Curve::ParseLUT(std::istream& lutFile)
+				if constexpr (std::is_same_v<Value_t, int32_t>)
+				{
+					const auto value = _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(frac, rise), base));
+					const auto exact = _mm_set1_epi32(belowValue);
+					const auto result = _mm_or_si128(_mm_and_si128(onPoint, exact), _mm_andnot_si128(onPoint, value));
+
+					_mm_storeu_si128(reinterpret_cast<__m128i*>(values + i), result);
+				}
+				else
+				{
+					const auto value = _mm_add_ps(base, _mm_mul_ps(frac, rise));
+					const auto mask = _mm_castsi128_ps(onPoint);
+					const auto result = _mm_or_ps(_mm_and_ps(mask, base), _mm_andnot_ps(mask, value));
+
+					_mm_storeu_ps(values + i, result);
+				}
+			}
+		}
+#endif
+
+		for (; i < count; ++i)
+			values[i] = Interpolate(refs[i], belowRef, aboveRef, belowValue, aboveValue);
+	}
+}
+
+template <typename RefType, typename ValueType>
+void BasicCurve<RefType, ValueType>::ParseLUT(std::string_view lutFile, Parse_t parse)
 {
-	std::string workingString;
+	const Trace::Span span("parse LUT");
+
+	uint64_t points = 0;
 
-	while (true)
+	while (lutFile.empty() == false)
 	{
-		// if we reach the end, we are done
-		if (std::getline(lutFile, workingString).fail() == true)
-			break;
+		// split off the next line. a '\r' from CRLF is trimmed with the whitespace
+		const auto lineEnd = lutFile.find('\n');
+		auto line = lutFile.substr(0, lineEnd);
+		lutFile.remove_prefix((lineEnd == std::string_view::npos) ? lutFile.size() : lineEnd + 1);
 
-		auto splitPos = workingString.find('|');
+		// drop comments
+		const auto commentPos = line.find_first_of(";#");
+		if (commentPos != std::string_view::npos)
+			line = line.substr(0, commentPos);
+
+		const auto splitPos = line.find('|');
 
 		// weed out any empty lines and invalid lines
-		if (splitPos == std::string::npos)
+		if (splitPos == std::string_view::npos)
 			continue;
 
-		const auto reference = atoi(workingString.substr(0, splitPos).c_str());
-		const auto value = atoi(workingString.substr(splitPos + 1).c_str());
+		Ref_t reference;
+		Value_t value;
+		if (ParseNumber(line.substr(0, splitPos), reference) == false || ParseNumber(line.substr(splitPos + 1), value) == false)
+			continue;
 
 		// make sure we are not using erroneous values
-		if (reference < 0 || value < 0)
+		if (parse == PARSE_POSITIVE && (reference < 0 || value < 0))
 			continue;
 
-		m_values.emplace(reference, value);
+		AddPoint(reference, value);
+		++points;
 	}
+
+	Stats::Add(Stats::COUNTER_LUTPOINTS, points);
+
+	// the grid no longer matches the points
+	m_step = 0;
+	m_grid.clear();
+}
+
+template <typename RefType, typename ValueType>
+void BasicCurve<RefType, ValueType>::ParseLUT(std::string_view lutFile, ErrorCode&, Parse_t parse)
+{
+	// invalid lines are skipped, so parsing has no error to report
+	ParseLUT(lutFile, parse);
+}
+
+template <typename RefType, typename ValueType>
+void BasicCurve<RefType, ValueType>::ParseLUT(std::istream& lutFile, Parse_t parse)
+{
+	const std::string contents{ std::istreambuf_iterator<char>(lutFile), std::istreambuf_iterator<char>() };
+
+	ParseLUT(std::string_view(contents), parse);
+}
+
+template <typename RefType, typename ValueType>
+void BasicCurve<RefType, ValueType>::ParseLUT(std::istream& lutFile, ErrorCode&, Parse_t parse)
+{
+	// invalid lines are skipped, so parsing has no error to report
+	ParseLUT(lutFile, parse);
+}
+
+template <typename RefType, typename ValueType>
+auto BasicCurve<RefType, ValueType>::GetMinRef() const -> Ref_t
+{
+	// make sure we have values
+	if (m_refs.size() == 0)
+		return 0;
+
+	return m_refs.front();
+}
+
+template <typename RefType, typename ValueType>
+auto BasicCurve<RefType, ValueType>::GetMaxRef() const -> Ref_t
+{
+	// make sure we have values
+	if (m_refs.size() == 0)
+		return 0;
+
+	return m_refs.back();
 }
 
-void Curve::ParseLUT(std::istream& lutFile, ErrorCode& ec)
+template <typename RefType, typename ValueType>
+auto BasicCurve<RefType, ValueType>::GetValue(const Ref_t ref) const -> Value_t
 {
-	try
+	Stats::Add(Stats::COUNTER_CURVEEVALUATIONS, 1);
+
+	if (m_step != 0)
+		return GetGridValue(ref);
+
+	return GetExactValue(ref);
+}
+
+template <typename RefType, typename ValueType>
+void BasicCurve<RefType, ValueType>::GetValue(const Ref_t* refs, Value_t* values, size_t count) const
+{
+	Stats::Add(Stats::COUNTER_CURVEEVALUATIONS, count);
+
+	// the grid needs no search, and sorted refs only need one walk over the points
+	if (m_step == 0 && std::is_sorted(refs, refs + count) == true)
 	{
-		ParseLUT(lutFile);
+		GetSortedValues(refs, values, count);
+		return;
 	}
-	catch (const ErrorCode& e)
+
+	for (size_t i = 0; i < count; ++i)
+		values[i] = (m_step != 0) ? GetGridValue(refs[i]) : GetExactValue(refs[i]);
+}
+
+template <typename RefType, typename ValueType>
+void BasicCurve<RefType, ValueType>::Resample(const Ref_t step)
+{
+	m_step = 0;
+	m_grid.clear();
+
+	if (step <= 0 || m_refs.size() < 2)
+		return;
+
+	const auto minRef = GetMinRef();
+	const auto span = static_cast<Offset_t<Ref_t>>(GetMaxRef()) - minRef;
+
+	// one cell per step, where the last one may be shorter
+	size_t cells;
+	if constexpr (std::is_integral_v<Ref_t>)
+		cells = static_cast<size_t>((span + step - 1) / step);
+	else
+		cells = static_cast<size_t>(std::ceil(span / step));
+
+	m_grid.reserve(cells + 1);
+	for (size_t i = 0; i < cells; ++i)
+		m_grid.push_back(GetExactValue(static_cast<Ref_t>(minRef + static_cast<Offset_t<Ref_t>>(i) * step)));
+	m_grid.push_back(m_values.back());
+
+	m_step = step;
+}
+
+template <typename RefType, typename ValueType>
+auto BasicCurve<RefType, ValueType>::GetStep() const noexcept -> Ref_t
+{
+	return m_step;
+}
+
+template <typename RefType, typename ValueType>
+auto BasicCurve<RefType, ValueType>::GetRefs() const noexcept -> const RefArray_t&
+{
+	return m_refs;
+}
+
+template <typename RefType, typename ValueType>
+auto BasicCurve<RefType, ValueType>::GetValues() const noexcept -> const ValueArray_t&
+{
+	return m_values;
+}
+
+template <typename RefType, typename ValueType>
+auto BasicCurve<RefType, ValueType>::GetStats() noexcept -> Stats_t
+{
+	const auto values = Stats::GetValues();
+
+	return { values[Stats::COUNTER_LUTPOINTS], values[Stats::COUNTER_CURVEEVALUATIONS] };
+}
+
+template <typename RefType, typename ValueType>
+void BasicCurve<RefType, ValueType>::AddPoint(const Ref_t ref, const Value_t value)
+{
+	// LUTs are written in ascending order, so this is almost always an append
+	if (m_refs.empty() == true || m_refs.back() < ref)
 	{
-		ec = e;
+		m_refs.push_back(ref);
+		m_values.push_back(value);
+		return;
 	}
+
+	const auto it = std::lower_bound(m_refs.begin(), m_refs.end(), ref);
+
+	// the first point with a reference wins
+	if (*it == ref)
+		return;
+
+	m_values.insert(m_values.begin() + (it - m_refs.begin()), value);
+	m_refs.insert(it, ref);
 }
 
-Curve::Data_t Curve::GetMinRef() const
+template <typename RefType, typename ValueType>
+auto BasicCurve<RefType, ValueType>::GetExactValue(const Ref_t ref) const -> Value_t
 {
-	// make sure we have values
-	if (m_values.size() == 0)
+	// the first reference above ref, the one before it is at or below ref
+	const auto above = UpperBound(m_refs.data(), m_refs.size(), ref);
+
+	// below the first reference, we cannot interpolate
+	if (above == 0)
+		return 0;
+
+	const auto below = above - 1;
+
+	// first check to see if the ref exactly matches
+	if (m_refs[below] == ref)
+		return m_values[below];
+
+	// if there is not an above value, we cannot interpolate.
+	if (above == m_refs.size())
 		return 0;
 
-	return m_values.cbegin()->first;
+	// use linear interpolation to find the value
+	return Interpolate(ref, m_refs[below], m_refs[above], m_values[below], m_values[above]); // https://goodaids.club/i/f2oi94wa30.png
 }
 
-Curve::Data_t Curve::GetMaxRef() const
+template <typename RefType, typename ValueType>
+auto BasicCurve<RefType, ValueType>::GetGridValue(const Ref_t ref) const -> Value_t
 {
-	// make sure we have values
-	if (m_values.size() == 0)
+	const auto minRef = GetMinRef();
+	const auto maxRef = GetMaxRef();
+
+	// outside of the curve, we cannot interpolate
+	if (ref < minRef || ref > maxRef)
 		return 0;
 
-	return (--m_values.cend())->first;
+	const auto offset = static_cast<Offset_t<Ref_t>>(ref) - minRef;
+	const auto cell = static_cast<size_t>(offset / m_step);
+
+	// the max reference is the last grid point
+	if (cell + 1 >= m_grid.size())
+		return m_grid.back();
+
+	const auto cellStart = static_cast<Offset_t<Ref_t>>(cell) * m_step;
+	const auto cellRef = offset - cellStart;
+
+	// grid points hold the exact value
+	if (cellRef == 0)
+		return m_grid[cell];
+
+	// the last cell ends at the max reference
+	const auto cellSize = std::min<Offset_t<Ref_t>>(m_step, (static_cast<Offset_t<Ref_t>>(maxRef) - minRef) - cellStart);
+
+	return Interpolate(static_cast<Ref_t>(cellRef), Ref_t(0), static_cast<Ref_t>(cellSize), m_grid[cell], m_grid[cell + 1]);
 }
 
-Curve::Data_t Curve::GetValue(const Data_t ref) const
+template <typename RefType, typename ValueType>
+void BasicCurve<RefType, ValueType>::GetSortedValues(const Ref_t* refs, Value_t* values, size_t count) const
 {
-	Map_t::iterator::value_type below, above;
+	const auto points = m_refs.size();
 
-	// search the map for the value above and below
-	for (auto it = m_values.cbegin(); it != m_values.cend();)
-	{
-		auto belowIt = it++;
+	size_t i = 0;
 
-		// first check to see if the ref exactly matches
-		if (ref == belowIt->first)
-			return belowIt->second;
+	// below the first reference, we cannot interpolate
+	for (; i < count && (points == 0 || refs[i] < m_refs.front()); ++i)
+		values[i] = 0;
 
-		// no need to make a copy here
-		const auto& aboveIt = it;
+	// the segment [m_refs[segment], m_refs[segment + 1]) holding the current ref
+	size_t segment = 0;
 
-		// if there is not an above value, we cannot interpolate.
-		if (aboveIt == m_values.cend())
-			return 0;
+	while (i < count)
+	{
+		while (segment + 1 < points && m_refs[segment + 1] <= refs[i])
+			++segment;
 
-		if (belowIt->first < ref &&
-			aboveIt->first > ref)
+		// at or past the last reference, only an exact match has a value
+		if (segment + 1 == points)
 		{
-			// bingo, use linear interpolation to find the value
-			auto frac = (ref - belowIt->first) / static_cast<float>(aboveIt->first - belowIt->first); // https://goodaids.club/i/f2oi94wa30.png
-			return static_cast<Data_t>((frac * (aboveIt->second - belowIt->second)) + belowIt->second);
+			values[i] = (refs[i] == m_refs.back()) ? m_values.back() : 0;
+			++i;
+			continue;
 		}
-	}
 
-	// we didn't find the value
-	return 0;
+		// every ref up to the next point shares this segment
+		auto end = i;
+		while (end < count && refs[end] < m_refs[segment + 1])
+			++end;
+
+		InterpolateSegment(refs + i, values + i, end - i, m_refs[segment], m_refs[segment + 1], m_values[segment], m_values[segment + 1]);
+		i = end;
+	}
 }
 
-const Curve::Map_t& Curve::GetValues() const noexcept
-{
-	return m_values;
-}
\ No newline at end of file
+template class Framework::BasicCurve<int32_t, int32_t>;
+template class Framework::BasicCurve<int32_t, float>;
+template class Framework::BasicCurve<double, double>;
@@ -0,0 +1,86 @@
+#include <Framework/Diagnostics.h>
+
+#include <Framework/Stats.h>
+#include <Framework/Trace.h>
+
+#include <algorithm>
+#include <ostream>
+
+using Framework::Diagnostics;
+using Framework::ErrorCode;
+using Framework::Stats;
+using Framework::Trace;
+
+Diagnostics::Diagnostics(std::vector<char*>& args)
+{
+	Parse(args);
+}
+
+Diagnostics::Diagnostics(std::vector<char*>& args, ErrorCode& ec) noexcept
+{
+	try
+	{
+		Parse(args);
+	}
+	catch (const ErrorCode& e)
+	{
+		ec = e;
+	}
+}
+
+void Diagnostics::Report(std::ostream& out) const
+{
+	if (m_stats == true)
+		Stats::Print(out);
+
+	if (m_traceFile.empty() == false)
+	{
+		ErrorCode ec;
+		Trace::Write(m_traceFile, ec);
+
+		if (ec != ErrorCode_SUCCESS)
+			out << "Failed to write trace: " << ec.GetMessage() << '\n';
+	}
+}
+
+const char* Diagnostics::GetUsage() noexcept
+{
+	return "Add --stats anywhere to print performance counters to stderr, and --trace [file] to write a Chrome trace of the run";
+}
+
+void Diagnostics::Parse(std::vector<char*>& args)
+{
+	if (args.empty() == true)
+		return;
+
+	const auto isArg = [](const char* name)
+	{
+		return [name](const char* arg) { return std::string(arg) == name; };
+	};
+
+	const auto statsArg = std::find_if(args.begin() + 1, args.end(), isArg("--stats"));
+
+	if (statsArg != args.end())
+	{
+		args.erase(statsArg);
+		m_stats = true;
+	}
+
+	const auto traceArg = std::find_if(args.begin() + 1, args.end(), isArg("--trace"));
+
+	if (traceArg != args.end())
+	{
+		if (traceArg + 1 == args.end())
+			throw ErrorCode(ErrorCode_FORMAT);
+
+		m_traceFile = *(traceArg + 1);
+		args.erase(traceArg, traceArg + 2);
+	}
+
+	// only once the arguments are known to be good
+	if (m_stats == true)
+		Stats::SetEnabled(true);
+
+	if (m_traceFile.empty() == false)
+		Trace::SetEnabled(true);
+}
@@ -3,45 +3,42 @@
 using Framework::_ErrorCode;
 using Framework::ErrorCode;
 
-ErrorCode::ErrorCode() : m_code(ErrorCode_SUCCESS)
+ErrorCode::ErrorCode() noexcept : m_code(ErrorCode_SUCCESS)
 {
-	m_message = "The operation completed successfully";
 }
 
-ErrorCode::ErrorCode(RawCode_t code) : m_code(code)
+ErrorCode::ErrorCode(RawCode_t code) noexcept : m_code(code)
+{
+}
+
+ErrorCode::RawCode_t ErrorCode::GetRawCode() const noexcept
+{
+	return m_code;
+}
+
+const char* ErrorCode::GetMessage() const noexcept
 {
 	switch (m_code)
 	{
 	case ErrorCode_SUCCESS:
-		m_message = "The operation completed successfully";
-		break;
+		return "The operation completed successfully";
 	case ErrorCode_FILENOTFOUND:
-		m_message = "The specified file was not found";
-		break;
+		return "The specified file was not found";
 	case ErrorCode_FILENOTOPEN:
-		m_message = "A file is not open";
-		break;
+		return "A file is not open";
 	case ErrorCode_FORMAT:
-		m_message = "The file format was invalid";
-		break;
+		return "The file format was invalid";
 	case ErrorCode_EOF:
-		m_message = "The end of the file was reached";
-		break;
+		return "The end of the file was reached";
+	case ErrorCode_MODE:
+		return "The operation is not supported by the current mode";
+	case ErrorCode_DEADLOCK:
+		return "The operation would wait on itself forever";
 	}
-	return;
-}
-
-ErrorCode::RawCode_t ErrorCode::GetRawCode() const
-{
-	return m_code;
-}
-
-std::string ErrorCode::GetMessage() const
-{
-	return m_message;
+	return "An unknown error occurred";
 }
 
-ErrorCode::operator ErrorCode::RawCode_t() const
+ErrorCode::operator ErrorCode::RawCode_t() const noexcept
 {
 	return m_code;
 }
\ No newline at end of file
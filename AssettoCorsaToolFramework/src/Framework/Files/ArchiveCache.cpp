@@ -0,0 +1,366 @@
+#include <Framework/Files/ArchiveCache.h>
+
+#include <Framework/Trace.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <thread>
+#include <utility>
+
+using Framework::ErrorCode;
+using Framework::Files::ArchiveCache;
+using Framework::Files::MappedFile;
+using Framework::Trace;
+
+namespace
+{
+	constexpr char IMAGE_MAGIC[8] = { 'A', 'C', 'D', 'C', 'A', 'C', 'H', 'E' };
+	// bump whenever the layout changes, older images are then ignored
+	constexpr uint32_t IMAGE_VERSION = 2;
+
+	// the bytes hashed at each end of an archive
+	constexpr size_t SAMPLE_SIZE = 4096;
+
+	// the image starts with a header, followed by a record per file, the names, and then the contents
+	struct Header
+	{
+		char magic[8];
+		uint32_t version;
+		uint32_t count;
+		uint64_t archiveSize;
+		int64_t archiveTime;
+		uint64_t archiveHash;
+		uint64_t keyHash;
+	};
+
+	// offsets are from the start of the image. contents that were not stored have an offset of 0
+	struct Record
+	{
+		uint64_t nameOffset;
+		uint64_t nameSize;
+		uint64_t contentsOffset;
+		uint64_t contentsSize;
+	};
+
+	static_assert(sizeof(Header) == 48 && sizeof(Record) == 32, "image layout must not have padding");
+
+	// FNV-1a, continuing from hash
+	uint64_t Hash(const char* data, size_t size, uint64_t hash = 14695981039346656037ull) noexcept
+	{
+		for (size_t i = 0; i < size; ++i)
+		{
+			hash ^= static_cast<unsigned char>(data[i]);
+			hash *= 1099511628211ull;
+		}
+
+		return hash;
+	}
+
+	// what identifies the state of an archive on disk
+	struct Stamp
+	{
+		uint64_t size;
+		int64_t time;
+		// covers both ends of the archive, which is where the table of contents and the last file change
+		uint64_t hash;
+	};
+
+	// returns false if the archive cannot be read
+	bool GetStamp(const std::string& fileName, Stamp& stamp) noexcept
+	{
+		std::error_code fsError;
+		const auto time = std::filesystem::last_write_time(fileName, fsError);
+
+		if (fsError)
+			return false;
+
+		ErrorCode ec;
+		const MappedFile archive(fileName, ec);
+
+		if (ec != Framework::ErrorCode_SUCCESS)
+			return false;
+
+		const auto size = archive.GetSize();
+		const auto sample = std::min(size, SAMPLE_SIZE);
+
+		stamp.size = size;
+		stamp.time = static_cast<int64_t>(time.time_since_epoch().count());
+		stamp.hash = Hash(archive.GetData(), sample);
+		stamp.hash = Hash(archive.GetData() + size - sample, sample, stamp.hash);
+
+		return true;
+	}
+}
+
+ArchiveCache::ArchiveCache(std::string directory)
+	: m_directory(std::move(directory))
+{
+	Create();
+}
+
+ArchiveCache::ArchiveCache(std::string directory, ErrorCode& ec) noexcept
+	: m_directory(std::move(directory))
+{
+	try
+	{
+		Create();
+	}
+	catch (const ErrorCode& e)
+	{
+		ec = e;
+	}
+}
+
+std::shared_ptr<const MappedFile> ArchiveCache::Find(const std::string& fileName, const Key_t& key, Entries_t& entries) const
+{
+	entries.clear();
+
+	Stamp stamp;
+	if (GetStamp(fileName, stamp) == false)
+		return nullptr;
+
+	ErrorCode ec;
+	auto image = std::make_shared<const MappedFile>(GetImagePath(fileName, key), ec);
+
+	// a missing image is a miss
+	if (ec != ErrorCode_SUCCESS || image->GetSize() < sizeof(Header))
+		return nullptr;
+
+	const auto data = image->GetData();
+	const auto size = static_cast<uint64_t>(image->GetSize());
+
+	Header header;
+	memcpy(&header, data, sizeof(header));
+
+	if (memcmp(header.magic, IMAGE_MAGIC, sizeof(IMAGE_MAGIC)) != 0 || header.version != IMAGE_VERSION)
+		return nullptr;
+
+	// the archive changed since the image was stored
+	if (header.archiveSize != stamp.size || header.archiveTime != stamp.time || header.archiveHash != stamp.hash
+		|| header.keyHash != Hash(key.data(), key.size()))
+		return nullptr;
+
+	if ((size - sizeof(Header)) / sizeof(Record) < header.count)
+		return nullptr;
+
+	entries.reserve(header.count);
+
+	for (uint32_t i = 0; i < header.count; ++i)
+	{
+		Record record;
+		memcpy(&record, data + sizeof(Header) + i * sizeof(Record), sizeof(record));
+
+		const auto stored = (record.contentsOffset != 0);
+
+		// a truncated or damaged image is a miss
+		if (record.nameOffset > size || record.nameSize > size - record.nameOffset
+			|| record.contentsOffset > size || record.contentsSize > size - record.contentsOffset)
+		{
+			entries.clear();
+			return nullptr;
+		}
+
+		entries.push_back({ File::View_t(data + record.nameOffset, static_cast<size_t>(record.nameSize)),
+			(stored == true) ? File::View_t(data + record.contentsOffset, static_cast<size_t>(record.contentsSize)) : File::View_t(), stored });
+	}
+
+	return image;
+}
+
+void ArchiveCache::Store(const std::string& fileName, const Key_t& key, const std::vector<File>& files) const
+{
+	Store(fileName, key, files, std::vector<bool>(files.size(), true));
+}
+
+void ArchiveCache::Store(const std::string& fileName, const Key_t& key, const std::vector<File>& files, ErrorCode& ec) const noexcept
+{
+	try
+	{
+		Store(fileName, key, files);
+	}
+	catch (const ErrorCode& e)
+	{
+		ec = e;
+	}
+}
+
+void ArchiveCache::Store(const std::string& fileName, const Key_t& key, const std::vector<File>& files, const std::vector<bool>& stored) const
+{
+	const Trace::Span span("store cached image", fileName);
+
+	Stamp stamp;
+	if (GetStamp(fileName, stamp) == false)
+		throw ErrorCode(ErrorCode_FILENOTFOUND);
+
+	Header header;
+	memcpy(header.magic, IMAGE_MAGIC, sizeof(IMAGE_MAGIC));
+	header.version = IMAGE_VERSION;
+	header.count = static_cast<uint32_t>(files.size());
+	header.archiveSize = stamp.size;
+	header.archiveTime = stamp.time;
+	header.archiveHash = stamp.hash;
+	header.keyHash = Hash(key.data(), key.size());
+
+	std::vector<Record> records(files.size());
+
+	// names come right after the records, and the contents after the names
+	uint64_t offset = sizeof(Header) + files.size() * sizeof(Record);
+	for (size_t i = 0; i < files.size(); ++i)
+	{
+		records[i].nameOffset = offset;
+		records[i].nameSize = files[i].GetName().size();
+		offset += records[i].nameSize;
+	}
+	for (size_t i = 0; i < files.size(); ++i)
+	{
+		if (stored[i] == false)
+		{
+			records[i].contentsOffset = 0;
+			records[i].contentsSize = 0;
+			continue;
+		}
+
+		records[i].contentsOffset = offset;
+		records[i].contentsSize = files[i].GetContentsView().size();
+		offset += records[i].contentsSize;
+	}
+
+	const auto path = GetImagePath(fileName, key);
+
+	RemoveStale(path);
+
+	// written to the side and moved into place, so a reader never maps a partial image
+	const auto tempPath = path + '.' + std::to_string(std::hash<std::thread::id>()(std::this_thread::get_id())) + ".tmp";
+
+	{
+		std::ofstream fileOut(tempPath, std::ios::binary | std::ios::trunc);
+
+		if (fileOut.good() == false)
+			throw ErrorCode(ErrorCode_FILENOTOPEN);
+
+		fileOut.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+		if (records.empty() == false)
+			fileOut.write(reinterpret_cast<const char*>(records.data()), records.size() * sizeof(Record));
+
+		for (const auto& file : files)
+			fileOut.write(file.GetName().data(), file.GetName().size());
+
+		for (size_t i = 0; i < files.size(); ++i)
+		{
+			if (stored[i] == false)
+				continue;
+
+			const auto contents = files[i].GetContentsView();
+			fileOut.write(contents.data(), contents.size());
+		}
+
+		fileOut.flush();
+
+		if (fileOut.good() == false)
+		{
+			fileOut.close();
+			std::remove(tempPath.c_str());
+			throw ErrorCode(ErrorCode_FILENOTOPEN);
+		}
+	}
+
+	std::error_code fsError;
+	std::filesystem::rename(tempPath, path, fsError);
+
+	// windows cannot replace an image that is still mapped, by this manager or another process, but it can move it
+	// aside. the old image stays mapped until its files are released, and is deleted by a later store
+	if (fsError)
+	{
+		const auto stalePath = path + '.' + std::to_string(std::hash<std::thread::id>()(std::this_thread::get_id())) + ".old";
+
+		fsError.clear();
+		std::filesystem::rename(path, stalePath, fsError);
+
+		if (fsError)
+		{
+			std::remove(tempPath.c_str());
+			throw ErrorCode(ErrorCode_FILENOTOPEN);
+		}
+
+		std::filesystem::rename(tempPath, path, fsError);
+		std::remove(stalePath.c_str());
+	}
+
+	if (fsError)
+	{
+		std::remove(tempPath.c_str());
+		throw ErrorCode(ErrorCode_FILENOTOPEN);
+	}
+}
+
+void ArchiveCache::Store(const std::string& fileName, const Key_t& key, const std::vector<File>& files, const std::vector<bool>& stored,
+	ErrorCode& ec) const noexcept
+{
+	try
+	{
+		Store(fileName, key, files, stored);
+	}
+	catch (const ErrorCode& e)
+	{
+		ec = e;
+	}
+}
+
+const std::string& ArchiveCache::GetDirectory() const noexcept
+{
+	return m_directory;
+}
+
+void ArchiveCache::Create()
+{
+	std::error_code fsError;
+	std::filesystem::create_directories(m_directory, fsError);
+
+	if (fsError || std::filesystem::is_directory(m_directory) == false)
+		throw ErrorCode(ErrorCode_FILENOTOPEN);
+}
+
+void ArchiveCache::RemoveStale(const std::string& path) const noexcept
+{
+	const auto prefix = std::filesystem::path(path).filename().string() + '.';
+
+	// images that were moved aside can only be deleted once nothing maps them anymore
+	std::error_code fsError;
+	// incremented without throwing, an error ends the walk
+	for (std::filesystem::directory_iterator it(m_directory, fsError), end; it != end; it.increment(fsError))
+	{
+		const auto& entry = *it;
+		const auto name = entry.path().filename().string();
+
+		if (name.size() > prefix.size() + 4 && name.compare(0, prefix.size(), prefix) == 0 && name.compare(name.size() - 4, 4, ".old") == 0)
+		{
+			std::error_code removeError;
+			std::filesystem::remove(entry.path(), removeError);
+		}
+	}
+}
+
+std::string ArchiveCache::GetImagePath(const std::string& fileName, const Key_t& key) const
+{
+	// the same archive can be reached by different paths, they should share an image
+	std::error_code fsError;
+	auto path = std::filesystem::weakly_canonical(fileName, fsError).string();
+
+	if (fsError)
+		path = fileName;
+
+	// the key is part of the name, an archive decrypted with another key is another image
+	auto hash = Hash(path.data(), path.size());
+	hash = Hash(key.data(), key.size() + 1, hash);
+
+	char name[32];
+	snprintf(name, sizeof(name), "%016llx.acdc", static_cast<unsigned long long>(hash));
+
+	return (std::filesystem::path(m_directory) / name).string();
+}
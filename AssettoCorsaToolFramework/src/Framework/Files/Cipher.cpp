@@ -0,0 +1,279 @@
+#include <Framework/Files/Cipher.h>
+
+#include <cstdint>
+#include <cstring>
+
+#if defined(_M_IX86) || defined(_M_X64) || defined(__i386__) || defined(__x86_64__)
+#define FRAMEWORK_CIPHER_X86
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#endif
+
+// gcc and clang only emit vector instructions for functions that ask for them
+#if defined(FRAMEWORK_CIPHER_X86) && !defined(_MSC_VER)
+#define FRAMEWORK_TARGET(isa) __attribute__((target(isa)))
+#else
+#define FRAMEWORK_TARGET(isa)
+#endif
+
+using Framework::Files::Cipher;
+
+namespace
+{
+	// the widest kernel processes this many bytes per iteration
+	constexpr size_t MAX_WIDTH = 32;
+
+	// decrypt kernels read from raw and write to out, encrypt kernels the other way around
+	using Kernel_t = void(*)(const char* src, char* dst, size_t count, const char* keyStream, size_t keySize, size_t keyPos);
+
+	// decrypts one byte at a time, starting at keyPos in the key. also finishes the tails of the wide kernels
+	void DecryptScalar(const char* raw, char* out, size_t count, const char* keyStream, size_t keySize, size_t keyPos)
+	{
+		for (size_t i = 0; i < count; ++i)
+		{
+			int32_t value;
+			memcpy(&value, raw + i * 4, 4);
+
+			out[i] = static_cast<char>(value) - keyStream[keyPos];
+
+			if (++keyPos == keySize)
+				keyPos = 0;
+		}
+	}
+
+	// encrypts one byte at a time, starting at keyPos in the key. also finishes the tails of the wide kernels
+	void EncryptScalar(const char* in, char* raw, size_t count, const char* keyStream, size_t keySize, size_t keyPos)
+	{
+		for (size_t i = 0; i < count; ++i)
+		{
+			const int32_t value = static_cast<uint8_t>(in[i] + keyStream[keyPos]);
+			memcpy(raw + i * 4, &value, 4);
+
+			if (++keyPos == keySize)
+				keyPos = 0;
+		}
+	}
+
+#ifdef FRAMEWORK_CIPHER_X86
+	FRAMEWORK_TARGET("sse2")
+	void DecryptSSE2(const char* raw, char* out, size_t count, const char* keyStream, size_t keySize, size_t keyPos)
+	{
+		constexpr size_t WIDTH = 16;
+
+		const auto mask = _mm_set1_epi32(0xFF);
+		const auto step = WIDTH % keySize;
+
+		size_t i = 0;
+		for (; i + WIDTH <= count; i += WIDTH)
+		{
+			const auto src = reinterpret_cast<const __m128i*>(raw + i * 4);
+
+			// only the low byte of each integer matters, masking keeps the packs from saturating
+			const auto a = _mm_and_si128(_mm_loadu_si128(src + 0), mask);
+			const auto b = _mm_and_si128(_mm_loadu_si128(src + 1), mask);
+			const auto c = _mm_and_si128(_mm_loadu_si128(src + 2), mask);
+			const auto d = _mm_and_si128(_mm_loadu_si128(src + 3), mask);
+
+			const auto bytes = _mm_packus_epi16(_mm_packs_epi32(a, b), _mm_packs_epi32(c, d));
+			const auto key = _mm_loadu_si128(reinterpret_cast<const __m128i*>(keyStream + keyPos));
+
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), _mm_sub_epi8(bytes, key));
+
+			keyPos += step;
+			if (keyPos >= keySize)
+				keyPos -= keySize;
+		}
+
+		DecryptScalar(raw + i * 4, out + i, count - i, keyStream, keySize, keyPos);
+	}
+
+	FRAMEWORK_TARGET("avx2")
+	void DecryptAVX2(const char* raw, char* out, size_t count, const char* keyStream, size_t keySize, size_t keyPos)
+	{
+		constexpr size_t WIDTH = 32;
+
+		const auto mask = _mm256_set1_epi32(0xFF);
+		// packs work within 128-bit lanes, this puts the 4-byte groups back in order
+		const auto order = _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7);
+		const auto step = WIDTH % keySize;
+
+		size_t i = 0;
+		for (; i + WIDTH <= count; i += WIDTH)
+		{
+			const auto src = reinterpret_cast<const __m256i*>(raw + i * 4);
+
+			const auto a = _mm256_and_si256(_mm256_loadu_si256(src + 0), mask);
+			const auto b = _mm256_and_si256(_mm256_loadu_si256(src + 1), mask);
+			const auto c = _mm256_and_si256(_mm256_loadu_si256(src + 2), mask);
+			const auto d = _mm256_and_si256(_mm256_loadu_si256(src + 3), mask);
+
+			const auto packed = _mm256_packus_epi16(_mm256_packs_epi32(a, b), _mm256_packs_epi32(c, d));
+			const auto bytes = _mm256_permutevar8x32_epi32(packed, order);
+			const auto key = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(keyStream + keyPos));
+
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), _mm256_sub_epi8(bytes, key));
+
+			keyPos += step;
+			if (keyPos >= keySize)
+				keyPos -= keySize;
+		}
+
+		DecryptScalar(raw + i * 4, out + i, count - i, keyStream, keySize, keyPos);
+	}
+
+	FRAMEWORK_TARGET("sse2")
+	void EncryptSSE2(const char* in, char* raw, size_t count, const char* keyStream, size_t keySize, size_t keyPos)
+	{
+		constexpr size_t WIDTH = 16;
+
+		const auto zero = _mm_setzero_si128();
+		const auto step = WIDTH % keySize;
+
+		size_t i = 0;
+		for (; i + WIDTH <= count; i += WIDTH)
+		{
+			const auto key = _mm_loadu_si128(reinterpret_cast<const __m128i*>(keyStream + keyPos));
+			const auto bytes = _mm_add_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i)), key);
+
+			// widen each byte to a 32-bit integer with zeros
+			const auto low = _mm_unpacklo_epi8(bytes, zero);
+			const auto high = _mm_unpackhi_epi8(bytes, zero);
+
+			const auto dst = reinterpret_cast<__m128i*>(raw + i * 4);
+			_mm_storeu_si128(dst + 0, _mm_unpacklo_epi16(low, zero));
+			_mm_storeu_si128(dst + 1, _mm_unpackhi_epi16(low, zero));
+			_mm_storeu_si128(dst + 2, _mm_unpacklo_epi16(high, zero));
+			_mm_storeu_si128(dst + 3, _mm_unpackhi_epi16(high, zero));
+
+			keyPos += step;
+			if (keyPos >= keySize)
+				keyPos -= keySize;
+		}
+
+		EncryptScalar(in + i, raw + i * 4, count - i, keyStream, keySize, keyPos);
+	}
+
+	FRAMEWORK_TARGET("avx2")
+	void EncryptAVX2(const char* in, char* raw, size_t count, const char* keyStream, size_t keySize, size_t keyPos)
+	{
+		constexpr size_t WIDTH = 32;
+
+		const auto step = WIDTH % keySize;
+
+		size_t i = 0;
+		for (; i + WIDTH <= count; i += WIDTH)
+		{
+			const auto key = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(keyStream + keyPos));
+			const auto bytes = _mm256_add_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + i)), key);
+
+			const auto low = _mm256_castsi256_si128(bytes);
+			const auto high = _mm256_extracti128_si256(bytes, 1);
+
+			// widen each group of 8 bytes to 8 32-bit integers with zeros
+			const auto dst = reinterpret_cast<__m256i*>(raw + i * 4);
+			_mm256_storeu_si256(dst + 0, _mm256_cvtepu8_epi32(low));
+			_mm256_storeu_si256(dst + 1, _mm256_cvtepu8_epi32(_mm_srli_si128(low, 8)));
+			_mm256_storeu_si256(dst + 2, _mm256_cvtepu8_epi32(high));
+			_mm256_storeu_si256(dst + 3, _mm256_cvtepu8_epi32(_mm_srli_si128(high, 8)));
+
+			keyPos += step;
+			if (keyPos >= keySize)
+				keyPos -= keySize;
+		}
+
+		EncryptScalar(in + i, raw + i * 4, count - i, keyStream, keySize, keyPos);
+	}
+
+	bool SupportsSSE2()
+	{
+#if defined(_M_X64) || defined(__x86_64__)
+		// part of the x64 baseline
+		return true;
+#elif defined(_MSC_VER)
+		int info[4];
+		__cpuid(info, 1);
+		return (info[3] & (1 << 26)) != 0;
+#else
+		return __builtin_cpu_supports("sse2");
+#endif
+	}
+
+	bool SupportsAVX2()
+	{
+#ifdef _MSC_VER
+		int info[4];
+		__cpuid(info, 0);
+		if (info[0] < 7)
+			return false;
+
+		// the OS must also save the ymm registers, which needs OSXSAVE and AVX
+		__cpuid(info, 1);
+		constexpr int OSXSAVE_AVX = (1 << 27) | (1 << 28);
+		if ((info[2] & OSXSAVE_AVX) != OSXSAVE_AVX || (_xgetbv(0) & 0x6) != 0x6)
+			return false;
+
+		__cpuidex(info, 7, 0);
+		return (info[1] & (1 << 5)) != 0;
+#else
+		return __builtin_cpu_supports("avx2");
+#endif
+	}
+#endif
+
+	// the widest kernels the processor supports
+	struct Kernels
+	{
+		Kernel_t decrypt = DecryptScalar;
+		Kernel_t encrypt = EncryptScalar;
+	};
+
+	Kernels SelectKernels()
+	{
+		Kernels kernels;
+
+#ifdef FRAMEWORK_CIPHER_X86
+		if (SupportsAVX2() == true)
+		{
+			kernels.decrypt = DecryptAVX2;
+			kernels.encrypt = EncryptAVX2;
+		}
+		else if (SupportsSSE2() == true)
+		{
+			kernels.decrypt = DecryptSSE2;
+			kernels.encrypt = EncryptSSE2;
+		}
+#endif
+		return kernels;
+	}
+
+	const Kernels& GetKernels()
+	{
+		static const Kernels kernels = SelectKernels();
+		return kernels;
+	}
+}
+
+Cipher::Cipher(const Key_t& key)
+{
+	// an empty key leaves the contents as they are
+	const auto& effectiveKey = key.empty() ? Key_t(1, '\0') : key;
+
+	m_keySize = effectiveKey.size();
+
+	// repeat the key until a full vector can be read from any position in it
+	m_keyStream.reserve(m_keySize + MAX_WIDTH);
+	while (m_keyStream.size() < m_keySize + MAX_WIDTH)
+		m_keyStream += effectiveKey;
+}
+
+void Cipher::Decrypt(const char* raw, char* out, size_t count, size_t position) const noexcept
+{
+	GetKernels().decrypt(raw, out, count, m_keyStream.data(), m_keySize, position % m_keySize);
+}
+
+void Cipher::Encrypt(const char* in, char* raw, size_t count, size_t position) const noexcept
+{
+	GetKernels().encrypt(in, raw, count, m_keyStream.data(), m_keySize, position % m_keySize);
+}
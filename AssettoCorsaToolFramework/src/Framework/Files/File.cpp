@@ -1,17 +1,37 @@
 #include <Framework/Files/File.h>
 
+#include <utility>
+
 using Framework::Files::File;
 
-File::File(const Data_t& name, const Data_t& contents)
-	: m_name(name), m_contents(contents) {}
+File::File(Data_t name, Data_t contents)
+	: m_name(std::move(name))
+{
+	auto buffer = std::make_shared<const Data_t>(std::move(contents));
 
+	m_contents = *buffer;
+	m_buffer = std::move(buffer);
+}
 
-File::Data_t File::GetName() const noexcept
+File::File(Data_t name, Buffer_t buffer, View_t contents) noexcept
+	: m_name(std::move(name)), m_buffer(std::move(buffer)), m_contents(contents) {}
+
+const File::Data_t& File::GetName() const noexcept
 {
 	return m_name;
 }
 
 File::Data_t File::GetContents() const noexcept
+{
+	return Data_t(m_contents);
+}
+
+File::View_t File::GetContentsView() const noexcept
 {
 	return m_contents;
+}
+
+const File::Buffer_t& File::GetBuffer() const noexcept
+{
+	return m_buffer;
 }
\ No newline at end of file
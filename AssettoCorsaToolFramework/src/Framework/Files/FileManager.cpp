@@ -1,88 +1,355 @@
 #include <Framework/Files/FileManager.h>
 
+#include <Framework/Stats.h>
+#include <Framework/ThreadPool.h>
+#include <Framework/Trace.h>
+
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
 #include <fstream>
+#include <limits>
+#include <thread>
 
 using Framework::ErrorCode;
+using Framework::Result;
+using Framework::Stats;
+using Framework::Trace;
 using Framework::Files::File;
 using Framework::Files::FileManager;
 
-FileManager::FileManager(const std::string& fileName, const std::string& directory, Mode_t mode)
-	: m_mode(mode)
+FileManager::FileManager(const std::string& fileName, const std::string& directory, Mode_t mode, size_t threadCount, const ArchiveCache* cache)
+	: m_mode(mode), m_threadCount(threadCount != 0 ? threadCount : std::max(1u, std::thread::hardware_concurrency())), m_cache(cache)
 {
 	CalculateKey(directory);
 
 	if (mode & MODE_READ)
+		ReadFiles(fileName);
+}
+
+FileManager::FileManager(const std::string& fileName, const std::string& directory, Mode_t mode, ErrorCode& ec, size_t threadCount, const ArchiveCache* cache) noexcept
+	: m_mode(mode), m_threadCount(threadCount != 0 ? threadCount : std::max(1u, std::thread::hardware_concurrency())), m_cache(cache)
+{
+	try
 	{
-		// create a temporary view of the file
-		std::ifstream fileIn(fileName, std::ios::binary);
+		CalculateKey(directory);
 
-		// if the file was not opened properly, throw an error
-		if (fileIn.good() == false)
-			throw ErrorCode(ErrorCode_FILENOTFOUND);
+		if (mode & MODE_READ)
+			ReadFiles(fileName);
+	}
+	catch (const ErrorCode& e)
+	{
+		ec = e;
+	}
+}
+
+FileManager::~FileManager()
+{
+	// only lazy managers leave files to store, everything else was stored when the archive was opened. files that were
+	// added or replaced are not in the archive, and the image would still match its stamp
+	if (m_cache == nullptr || m_mapping == nullptr || m_modified == true)
+		return;
+
+	const auto loadedCount = static_cast<size_t>(std::count(m_loaded.cbegin(), m_loaded.cend(), true));
 
-		DecryptFiles(fileIn);
+	if (loadedCount > m_storedCount)
+		StoreImage(m_fileName, &m_loaded);
+}
 
-		fileIn.close();
+const File& FileManager::GetFile(std::string_view fileName) const
+{
+	return *TryGetFile(fileName).GetValue();
+}
+
+const File& FileManager::GetFile(std::string_view fileName, ErrorCode& ec) const noexcept
+{
+	static const File empty("", "");
+
+	// misses are common for optional files, so they are not thrown
+	const auto file = TryGetFile(fileName);
+
+	if (file.HasValue() == false)
+	{
+		ec = file.GetError();
+		return empty;
 	}
+
+	return *file.GetValue();
 }
 
-FileManager::FileManager(const std::string& fileName, const std::string& directory, Mode_t mode, ErrorCode& ec) noexcept
-	: m_mode(mode)
+const File* FileManager::FindFile(std::string_view fileName) const noexcept
 {
-	CalculateKey(directory);
+	return TryGetFile(fileName).GetValueOr(nullptr);
+}
 
-	if (mode & MODE_READ)
+Result<const File*> FileManager::TryGetFile(std::string_view fileName) const noexcept
+{
+	Stats::Add(Stats::COUNTER_LOOKUPS, 1);
+
+	// only the search, a lazy file is decrypted below and counted with the decryption
+	auto it = m_index.cend();
 	{
-		// create a temporary view of the file
-		std::ifstream fileIn(fileName, std::ios::binary);
+		const Stats::Timer timer(Stats::COUNTER_LOOKUPTIME);
+		it = m_index.find(fileName);
+	}
 
-		// if the file was not opened properly, throw an error
-		if (fileIn.good() == false)
+	if (it == m_index.cend())
+		return ErrorCode_FILENOTFOUND;
+
+	LoadFile(it->second);
+	return &m_files[it->second];
+}
+
+const FileManager::Vec_t& FileManager::GetFiles() const noexcept
+{
+	LoadFiles();
+
+	return m_files;
+}
+
+FileManager::Vec_t::const_iterator FileManager::begin() const noexcept
+{
+	return GetFiles().cbegin();
+}
+
+FileManager::Vec_t::const_iterator FileManager::end() const noexcept
+{
+	return GetFiles().cend();
+}
+
+void FileManager::VisitFiles(const Visitor_t& visitor, size_t chunkSize) const
+{
+	// the only buffer used for files that are not in memory yet
+	std::string buffer;
+
+	for (size_t i = 0; i < m_entries.size(); ++i)
+	{
+		const auto& entry = m_entries[i];
+		const auto step = (chunkSize == 0) ? entry.size : chunkSize;
+
+		// files that are already decrypted are passed straight from memory
+		if (IsLoaded(i) == true)
 		{
-			ec = ErrorCode_FILENOTFOUND;
-			return;
+			const auto contents = m_files[i].GetContentsView();
+
+			size_t offset = 0;
+			do
+			{
+				const auto chunk = contents.substr(offset, step);
+
+				visitor(entry.name, chunk, offset, contents.size());
+				offset += chunk.size();
+			} while (offset < contents.size());
+
+			continue;
+		}
+
+		size_t offset = 0;
+		do
+		{
+			const auto count = std::min(step, entry.size - offset);
+
+			if (buffer.size() < count)
+				buffer.resize(count);
+
+			{
+				const Trace::Span span("decrypt entry", entry.name);
+				const Stats::Timer timer(Stats::COUNTER_DECRYPTTIME);
+				m_cipher.Decrypt(m_mapping->GetData() + entry.offset + offset * 4, &buffer[0], count, offset);
+			}
+
+			Stats::Add(Stats::COUNTER_ENTRIESDECRYPTED, (offset == 0) ? 1 : 0);
+			Stats::Add(Stats::COUNTER_BYTESDECRYPTED, count);
+			Stats::Add(Stats::COUNTER_BYTESREAD, count * 4);
+
+			visitor(entry.name, File::View_t(buffer.data(), count), offset, entry.size);
+			offset += count;
+		} while (offset < entry.size);
+	}
+}
+
+void FileManager::ForEachFile(const FileVisitor_t& visitor) const
+{
+	for (size_t i = 0; i < m_entries.size(); ++i)
+	{
+		if (IsLoaded(i) == true)
+		{
+			visitor(m_files[i]);
+			continue;
 		}
 
-		DecryptFiles(fileIn);
+		const auto& entry = m_entries[i];
+
+		auto buffer = std::make_shared<std::string>(entry.size, '\0');
+		DecryptEntry(entry, &(*buffer)[0]);
 
-		fileIn.close();
+		visitor(File(entry.name, buffer, *buffer));
 	}
+}
 
-	CalculateKey(directory);
+void FileManager::AddFile(File file)
+{
+	if ((m_mode & MODE_WRITE) == 0)
+		throw ErrorCode(ErrorCode_MODE);
+
+	InsertFile(std::move(file));
 }
 
-File FileManager::GetFile(const std::string& fileName) const
+void FileManager::AddFile(File file, ErrorCode& ec) noexcept
 {
-	// try to find the file in our vector of files
-	for (const auto& file : m_files)
+	if ((m_mode & MODE_WRITE) == 0)
+	{
+		ec = ErrorCode(ErrorCode_MODE);
+		return;
+	}
+
+	InsertFile(std::move(file));
+}
+
+void FileManager::AddFiles(const FileManager& other)
+{
+	if ((m_mode & MODE_WRITE) == 0)
+		throw ErrorCode(ErrorCode_MODE);
+
+	// copies share the other manager's buffers
+	for (const auto& file : other)
+		InsertFile(file);
+}
+
+void FileManager::AddFiles(const FileManager& other, ErrorCode& ec) noexcept
+{
+	if ((m_mode & MODE_WRITE) == 0)
 	{
-		if (file.GetName() == fileName)
-			return file;
+		ec = ErrorCode(ErrorCode_MODE);
+		return;
 	}
-	
-	throw ErrorCode(ErrorCode_FILENOTFOUND);
+
+	for (const auto& file : other)
+		InsertFile(file);
 }
 
-File FileManager::GetFile(const std::string& fileName, ErrorCode& ec) const noexcept
+void FileManager::InsertFile(File file)
+{
+	m_modified = true;
+
+	const auto it = m_index.find(file.GetName());
+
+	// replace the existing file in place, so the order does not change
+	if (it != m_index.cend())
+	{
+		m_entries[it->second].size = file.GetContentsView().size();
+		m_files[it->second] = std::move(file);
+		m_loaded[it->second] = true;
+		return;
+	}
+
+	const auto capacity = m_entries.capacity();
+
+	m_entries.push_back({ file.GetName(), 0, file.GetContentsView().size() });
+	m_files.push_back(std::move(file));
+	m_loaded.push_back(true);
+
+	// the index holds views into m_entries, which may have moved
+	if (m_entries.capacity() != capacity)
+	{
+		m_index.clear();
+		BuildIndex();
+	}
+	else
+		m_index.emplace(m_entries.back().name, m_entries.size() - 1);
+}
+
+void FileManager::AddDirectory(const std::string& path)
+{
+	if ((m_mode & MODE_WRITE) == 0)
+		throw ErrorCode(ErrorCode_MODE);
+
+	std::error_code fsError;
+	std::filesystem::directory_iterator it(path, fsError);
+
+	if (fsError)
+		throw ErrorCode(ErrorCode_FILENOTFOUND);
+
+	for (const auto& dirEntry : it)
+	{
+		if (dirEntry.is_regular_file() == false)
+			continue;
+
+		std::ifstream fileIn(dirEntry.path(), std::ios::binary);
+
+		if (fileIn.good() == false)
+			throw ErrorCode(ErrorCode_FILENOTOPEN);
+
+		std::string contents(static_cast<size_t>(dirEntry.file_size()), '\0');
+
+		if (contents.empty() == false && fileIn.read(&contents[0], contents.size()).fail() == true)
+			throw ErrorCode(ErrorCode_EOF);
+
+		InsertFile(File(dirEntry.path().filename().string(), std::move(contents)));
+	}
+}
+
+void FileManager::AddDirectory(const std::string& path, ErrorCode& ec) noexcept
 {
 	try
 	{
-		return GetFile(fileName);
+		AddDirectory(path);
 	}
 	catch (const ErrorCode& e)
 	{
 		ec = e;
 	}
-	return File("", "");
 }
 
-FileManager::Vec_t FileManager::GetFiles() const noexcept
+void FileManager::WriteFiles(const std::string& fileName) const
 {
-	return m_files;
+	if ((m_mode & MODE_WRITE) == 0)
+		throw ErrorCode(ErrorCode_MODE);
+
+	// everything read from the archive has to be decrypted before it can be encrypted again
+	LoadFiles();
+
+	std::ofstream fileOut(fileName, std::ios::binary | std::ios::trunc);
+
+	if (fileOut.good() == false)
+		throw ErrorCode(ErrorCode_FILENOTOPEN);
+
+	// reused for every file, so files are streamed to disk a chunk at a time
+	std::vector<char> raw;
+
+	for (const auto& file : m_files)
+		EncryptFile(file, fileOut, raw);
+
+	fileOut.flush();
+
+	if (fileOut.good() == false)
+		throw ErrorCode(ErrorCode_FILENOTOPEN);
+}
+
+void FileManager::WriteFiles(const std::string& fileName, ErrorCode& ec) const noexcept
+{
+	try
+	{
+		WriteFiles(fileName);
+	}
+	catch (const ErrorCode& e)
+	{
+		ec = e;
+	}
+}
+
+FileManager::Stats_t FileManager::GetStats() noexcept
+{
+	const auto values = Stats::GetValues();
+
+	return { values[Stats::COUNTER_BYTESREAD], values[Stats::COUNTER_ENTRIESDECRYPTED], values[Stats::COUNTER_BYTESDECRYPTED],
+		values[Stats::COUNTER_DECRYPTTIME], values[Stats::COUNTER_LOOKUPS], values[Stats::COUNTER_LOOKUPTIME] };
 }
 
 void FileManager::CalculateKey(const std::string& directory)
 {
+	const Trace::Span span("derive key", directory);
+
 	/*
 	 *	This mimics the behavior of Assetto Corsa's ksSecurity::keyFromString
 	 */
@@ -156,6 +423,168 @@ void FileManager::CalculateKey(const std::string& directory)
 		uint8_t(factor4), uint8_t(factor5), uint8_t(factor6), uint8_t(factor7));
 
 	m_key = tmp;
+	m_cipher = Cipher(m_key);
+}
+
+void FileManager::ReadFiles(const std::string& fileName)
+{
+	const Trace::Span span("open archive", fileName);
+
+	if (m_cache == nullptr)
+	{
+		DecryptArchive(fileName);
+		return;
+	}
+
+	m_fileName = fileName;
+
+	if (ReadImage(fileName) == true)
+		return;
+
+	DecryptArchive(fileName);
+
+	// with MODE_LAZY, the files that get loaded are stored by the destructor, so opening stays lazy
+	if (m_mode & MODE_LAZY)
+		return;
+
+	StoreImage(fileName, nullptr);
+}
+
+void FileManager::StoreImage(const std::string& fileName, const std::vector<bool>* stored) noexcept
+{
+	ErrorCode ec;
+
+	if (stored == nullptr)
+		m_cache->Store(fileName, m_key, m_files, ec);
+	else
+		m_cache->Store(fileName, m_key, m_files, *stored, ec);
+
+	// a failure to store the image only means decrypting again next time, so it is counted rather than thrown
+	if (ec != ErrorCode_SUCCESS)
+	{
+		Stats::Add(Stats::COUNTER_CACHEFAILURES, 1);
+		return;
+	}
+
+	m_storedCount = static_cast<size_t>(std::count(m_loaded.cbegin(), m_loaded.cend(), true));
+}
+
+void FileManager::DecryptArchive(const std::string& fileName)
+{
+	// entries can only be decrypted independently out of a mapping
+	if ((m_mode & (MODE_MAP | MODE_LAZY)) || m_threadCount > 1)
+	{
+		m_mapping = std::make_unique<MappedFile>(fileName);
+
+		ReadEntries();
+		BuildIndex();
+
+		// hold a spot for every file, they are filled in as they are decrypted
+		m_files.reserve(m_entries.size());
+		for (const auto& entry : m_entries)
+			m_files.emplace_back(entry.name, std::string());
+
+		m_loaded.assign(m_entries.size(), false);
+
+		if (m_mode & MODE_LAZY)
+			return;
+
+		LoadFiles();
+
+		// everything is decrypted, the mapping is no longer needed
+		m_mapping.reset();
+		return;
+	}
+
+	// create a temporary view of the file
+	std::ifstream fileIn(fileName, std::ios::binary);
+
+	// if the file was not opened properly, throw an error
+	if (fileIn.good() == false)
+		throw ErrorCode(ErrorCode_FILENOTFOUND);
+
+	DecryptFiles(fileIn);
+	BuildIndex();
+
+	m_loaded.assign(m_entries.size(), true);
+}
+
+bool FileManager::ReadImage(const std::string& fileName)
+{
+	const Trace::Span span("read cached image", fileName);
+
+	ArchiveCache::Entries_t entries;
+	const auto image = m_cache->Find(fileName, m_key, entries);
+
+	if (image == nullptr)
+		return false;
+
+	m_storedCount = static_cast<size_t>(std::count_if(entries.cbegin(), entries.cend(), [](const ArchiveCache::Entry& entry) { return entry.stored; }));
+
+	if (m_storedCount == entries.size())
+	{
+		m_entries.reserve(entries.size());
+		m_files.reserve(entries.size());
+
+		// the files are views into the image, which stays mapped as long as any of them is alive
+		for (const auto& entry : entries)
+		{
+			m_entries.push_back({ std::string(entry.name), 0, entry.contents.size() });
+			m_files.emplace_back(std::string(entry.name), image, entry.contents);
+
+			Stats::Add(Stats::COUNTER_BYTESREAD, entry.contents.size());
+		}
+
+		BuildIndex();
+
+		m_loaded.assign(m_entries.size(), true);
+		return true;
+	}
+
+	// some files were never loaded, so the archive is needed for them
+	m_mapping = std::make_unique<MappedFile>(fileName);
+	ReadEntries();
+
+	const auto matches = (m_entries.size() == entries.size()) && std::equal(m_entries.cbegin(), m_entries.cend(), entries.cbegin(),
+		[](const Entry& entry, const ArchiveCache::Entry& imageEntry) { return entry.name == imageEntry.name; });
+
+	if (matches == false)
+	{
+		m_entries.clear();
+		m_mapping.reset();
+		m_storedCount = 0;
+		return false;
+	}
+
+	BuildIndex();
+
+	m_files.reserve(m_entries.size());
+	m_loaded.assign(m_entries.size(), false);
+
+	for (size_t i = 0; i < entries.size(); ++i)
+	{
+		if (entries[i].stored == false)
+		{
+			m_files.emplace_back(m_entries[i].name, std::string());
+			continue;
+		}
+
+		m_files.emplace_back(m_entries[i].name, image, entries[i].contents);
+		m_loaded[i] = true;
+
+		Stats::Add(Stats::COUNTER_BYTESREAD, entries[i].contents.size());
+	}
+
+	if (m_mode & MODE_LAZY)
+		return true;
+
+	LoadFiles();
+	m_mapping.reset();
+
+	// the image is complete from now on
+	StoreImage(fileName, nullptr);
+
+	return true;
 }
 
 void FileManager::DecryptFiles(std::ifstream& fileIn)
@@ -194,6 +623,8 @@ void FileManager::DecryptFiles(std::ifstream& fileIn)
 		if (fileIn.read(reinterpret_cast<char*>(&size), 4).fail() == true)
 			break;
 
+		const auto offset = static_cast<size_t>(fileIn.tellg());
+
 		std::string decContents;
 
 		if (size > 0)
@@ -208,13 +639,234 @@ void FileManager::DecryptFiles(std::ifstream& fileIn)
 				break;
 
 			// decrypt the contents
-			for (size_t i = 0; i < size; ++i)
-			{
-				decContents[i] = static_cast<char>(rawContents[i]) - m_key[i % m_key.size()];
-			}
+			const Trace::Span span("decrypt entry", name);
+			const Stats::Timer timer(Stats::COUNTER_DECRYPTTIME);
+			m_cipher.Decrypt(reinterpret_cast<const char*>(rawContents.data()), &decContents[0], size);
 		}
+
+		Stats::Add(Stats::COUNTER_ENTRIESDECRYPTED, 1);
+		Stats::Add(Stats::COUNTER_BYTESDECRYPTED, decContents.size());
+		Stats::Add(Stats::COUNTER_BYTESREAD, decContents.size() * 4);
 		
-		// add the file to the vector
-		m_files.emplace_back(name, decContents);
+		// add the file to the table of contents and the vector
+		m_entries.push_back({ name, offset, decContents.size() });
+		m_files.emplace_back(std::move(name), std::move(decContents));
+	}
+}
+
+void FileManager::ReadEntries()
+{
+	/*
+	 *	Same layout as DecryptFiles, but only the headers are read
+	 *	and the contents are skipped over
+	 */
+
+	const char* const begin = m_mapping->GetData();
+	const char* const end = begin + m_mapping->GetSize();
+	const char* cursor = begin;
+
+	// reads a 32-bit integer at the cursor, fails if the archive is truncated
+	const auto readInt = [&cursor, end](int32_t& value)
+	{
+		if (end - cursor < 4)
+			return false;
+
+		memcpy(&value, cursor, 4);
+		cursor += 4;
+		return true;
+	};
+
+	while (true)
+	{
+		int32_t size;
+
+		// try to read the size of the name
+		if (readInt(size) == false)
+			break;
+
+		// corner case, just advance to position 8
+		if (size == -1111)
+		{
+			if (end - begin < 8)
+				break;
+
+			cursor = begin + 8;
+			if (readInt(size) == false)
+				break;
+		}
+
+		// make sure the name is actually in the archive
+		if (size < 0 || end - cursor < size)
+			break;
+
+		std::string name(cursor, size);
+		cursor += size;
+
+		// read the size of the file
+		if (readInt(size) == false)
+			break;
+
+		// each byte is stored as a 32-bit integer, make sure they are all there
+		if (size < 0)
+			size = 0;
+		else if ((end - cursor) / 4 < size)
+			break;
+
+		m_entries.push_back({ std::move(name), static_cast<size_t>(cursor - begin), static_cast<size_t>(size) });
+
+		cursor += static_cast<size_t>(size) * 4;
+	}
+}
+
+void FileManager::DecryptEntry(const Entry& entry, char* out) const
+{
+	{
+		const Trace::Span span("decrypt entry", entry.name);
+		const Stats::Timer timer(Stats::COUNTER_DECRYPTTIME);
+		m_cipher.Decrypt(m_mapping->GetData() + entry.offset, out, entry.size);
 	}
-}
\ No newline at end of file
+
+	Stats::Add(Stats::COUNTER_ENTRIESDECRYPTED, 1);
+	Stats::Add(Stats::COUNTER_BYTESDECRYPTED, entry.size);
+	Stats::Add(Stats::COUNTER_BYTESREAD, entry.size * 4);
+}
+
+bool FileManager::IsLoaded(size_t index) const
+{
+	// only lazy managers keep the mapping, everything else is loaded before the constructor returns
+	if (m_mapping == nullptr)
+		return true;
+
+	std::lock_guard<std::mutex> lock(m_loadMutex);
+	return m_loaded[index];
+}
+
+void FileManager::LoadFile(size_t index) const
+{
+	if (IsLoaded(index) == true)
+		return;
+
+	const auto& entry = m_entries[index];
+
+	// decrypted without the lock, so lookups of other files are not held up
+	auto buffer = std::make_shared<std::string>(entry.size, '\0');
+	DecryptEntry(entry, &(*buffer)[0]);
+
+	// another thread may have loaded it meanwhile, and files that were handed out must not change
+	std::lock_guard<std::mutex> lock(m_loadMutex);
+	if (m_loaded[index] == false)
+	{
+		m_files[index] = File(entry.name, buffer, *buffer);
+		m_loaded[index] = true;
+	}
+}
+
+void FileManager::LoadFiles() const
+{
+	if (m_mapping == nullptr)
+		return;
+
+	// held throughout, so two threads never decrypt the whole archive at once
+	std::lock_guard<std::mutex> lock(m_loadMutex);
+
+	std::vector<size_t> pending;
+	size_t totalSize = 0;
+	for (size_t i = 0; i < m_loaded.size(); ++i)
+	{
+		if (m_loaded[i] == false)
+		{
+			pending.push_back(i);
+			totalSize += m_entries[i].size;
+		}
+	}
+
+	// every pending file is decrypted into its own region of one buffer
+	auto buffer = std::make_shared<std::string>(totalSize, '\0');
+
+	std::vector<size_t> offsets(pending.size());
+	for (size_t i = 0, offset = 0; i < pending.size(); ++i)
+	{
+		offsets[i] = offset;
+		offset += m_entries[pending[i]].size;
+	}
+
+	const auto load = [this, &pending, &offsets, &buffer](size_t i)
+	{
+		const auto& entry = m_entries[pending[i]];
+		const auto contents = &(*buffer)[0] + offsets[i];
+
+		DecryptEntry(entry, contents);
+		m_files[pending[i]] = File(entry.name, buffer, File::View_t(contents, entry.size));
+	};
+
+	if (m_threadCount > 1 && pending.size() > 1)
+	{
+		// start with the largest entries so they do not finish last
+		std::vector<size_t> order(pending.size());
+		for (size_t i = 0; i < order.size(); ++i)
+			order[i] = i;
+
+		std::sort(order.begin(), order.end(), [this, &pending](size_t lhs, size_t rhs)
+		{
+			return m_entries[pending[lhs]].size > m_entries[pending[rhs]].size;
+		});
+
+		// every task writes to its own slot and region, so the order of m_files is unchanged
+		ThreadPool pool(std::min(m_threadCount, pending.size()));
+		pool.ParallelFor(order.size(), [&order, &load](size_t i)
+		{
+			load(order[i]);
+		});
+	}
+	else
+	{
+		for (size_t i = 0; i < pending.size(); ++i)
+			load(i);
+	}
+
+	m_loaded.assign(m_loaded.size(), true);
+}
+
+void FileManager::EncryptFile(const File& file, std::ofstream& fileOut, std::vector<char>& raw) const
+{
+	/*
+	 *	The reverse of DecryptFiles, without the -1111 header
+	 */
+
+	// bytes encrypted per write, each one takes 4 bytes on disk
+	constexpr size_t CHUNK_SIZE = 1024 * 1024;
+
+	const auto& name = file.GetName();
+	const auto contents = file.GetContentsView();
+
+	// sizes are stored as 32-bit integers
+	constexpr size_t MAX_SIZE = std::numeric_limits<int32_t>::max();
+	if (name.size() > MAX_SIZE || contents.size() > MAX_SIZE)
+		throw ErrorCode(ErrorCode_FORMAT);
+
+	auto size = static_cast<int32_t>(name.size());
+	fileOut.write(reinterpret_cast<const char*>(&size), 4);
+	fileOut.write(name.data(), name.size());
+
+	size = static_cast<int32_t>(contents.size());
+	fileOut.write(reinterpret_cast<const char*>(&size), 4);
+
+	raw.resize(std::min(contents.size(), CHUNK_SIZE) * 4);
+
+	for (size_t offset = 0; offset < contents.size(); offset += CHUNK_SIZE)
+	{
+		const auto count = std::min(CHUNK_SIZE, contents.size() - offset);
+
+		m_cipher.Encrypt(contents.data() + offset, raw.data(), count, offset);
+		fileOut.write(raw.data(), count * 4);
+	}
+}
+
+void FileManager::BuildIndex()
+{
+	m_index.reserve(m_entries.size());
+
+	// the first entry wins if a name is duplicated, as with a linear search
+	for (size_t i = 0; i < m_entries.size(); ++i)
+		m_index.emplace(m_entries[i].name, i);
+}
@@ -0,0 +1,315 @@
+#include <Framework/Files/FileWriter.h>
+
+#include <Framework/Trace.h>
+
+#include <algorithm>
+#include <filesystem>
+#include <string_view>
+#include <utility>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+using Framework::ErrorCode;
+using Framework::Files::FileWriter;
+using Framework::Trace;
+
+namespace
+{
+#ifdef _WIN32
+	// writes contents at offset into path, which is size bytes in total. with create, the file is created or
+	// truncated and size bytes are reserved first, otherwise it is opened as it is
+	ErrorCode WriteAt(const std::string& path, std::string_view contents, size_t offset, size_t size, bool create)
+	{
+		// pieces of the same file are written from more than one thread
+		const auto file = CreateFileA(path.c_str(), GENERIC_WRITE, FILE_SHARE_WRITE, nullptr,
+			(create == true) ? CREATE_ALWAYS : OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+
+		if (file == INVALID_HANDLE_VALUE)
+			return Framework::ErrorCode_FILENOTOPEN;
+
+		// reserve the whole file up front so it is not extended on every write
+		if (create == true)
+		{
+			FILE_ALLOCATION_INFO allocation;
+			allocation.AllocationSize.QuadPart = static_cast<LONGLONG>(size);
+			SetFileInformationByHandle(file, FileAllocationInfo, &allocation, sizeof(allocation));
+		}
+
+		LARGE_INTEGER position;
+		position.QuadPart = static_cast<LONGLONG>(offset);
+
+		if (SetFilePointerEx(file, position, nullptr, FILE_BEGIN) == FALSE)
+		{
+			CloseHandle(file);
+			return Framework::ErrorCode_FILENOTOPEN;
+		}
+
+		// WriteFile takes 32-bit sizes, so anything larger than 4GB takes more than one write
+		size_t written = 0;
+		while (written < contents.size())
+		{
+			const auto count = static_cast<DWORD>(std::min<size_t>(contents.size() - written, MAXDWORD));
+
+			DWORD result = 0;
+			if (WriteFile(file, contents.data() + written, count, &result, nullptr) == FALSE)
+			{
+				CloseHandle(file);
+				return Framework::ErrorCode_FILENOTOPEN;
+			}
+
+			written += result;
+		}
+
+		CloseHandle(file);
+		return Framework::ErrorCode_SUCCESS;
+	}
+#else
+	// writes contents at offset into path, which is size bytes in total. with create, the file is created or
+	// truncated and size bytes are reserved first, otherwise it is opened as it is
+	ErrorCode WriteAt(const std::string& path, std::string_view contents, size_t offset, size_t size, bool create)
+	{
+		const auto file = open(path.c_str(), (create == true) ? (O_WRONLY | O_CREAT | O_TRUNC) : O_WRONLY, 0644);
+
+		if (file == -1)
+			return Framework::ErrorCode_FILENOTOPEN;
+
+#ifdef __linux__
+		// reserve the whole file up front so it is not extended on every write
+		if (create == true && size != 0)
+			posix_fallocate(file, 0, static_cast<off_t>(size));
+#endif
+
+		// a single write, unless the kernel returns early
+		size_t written = 0;
+		while (written < contents.size())
+		{
+			const auto result = pwrite(file, contents.data() + written, contents.size() - written, static_cast<off_t>(offset + written));
+
+			if (result < 0)
+			{
+				close(file);
+				return Framework::ErrorCode_FILENOTOPEN;
+			}
+
+			written += static_cast<size_t>(result);
+		}
+
+		close(file);
+		return Framework::ErrorCode_SUCCESS;
+	}
+#endif
+}
+
+FileWriter::FileWriter(size_t threadCount, size_t maxQueuedBytes)
+	: m_maxQueuedBytes(maxQueuedBytes)
+{
+	if (threadCount == 0)
+		threadCount = 1;
+
+	m_writers.reserve(threadCount);
+	for (size_t i = 0; i < threadCount; ++i)
+		m_writers.emplace_back(&FileWriter::WriterLoop, this);
+}
+
+FileWriter::~FileWriter()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_stopping = true;
+	}
+	m_jobReady.notify_all();
+
+	for (auto& writer : m_writers)
+		writer.join();
+}
+
+void FileWriter::Write(std::string path, File file, Callback_t callback)
+{
+	const auto size = file.GetContentsView().size();
+
+	Queue({ std::move(path), std::move(file), std::move(callback), nullptr, 0, size });
+}
+
+void FileWriter::WriteChunk(std::string path, File::View_t chunk, size_t offset, size_t size, Callback_t callback)
+{
+	std::shared_ptr<Stream> stream;
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+
+		auto& entry = m_streams[path];
+
+		// the first piece starts the file over
+		if (offset == 0 || entry == nullptr)
+		{
+			entry = std::make_shared<Stream>();
+			entry->callback = std::move(callback);
+			entry->remaining = size;
+		}
+
+		stream = entry;
+
+		// the jobs keep the stream alive from here
+		if (offset + chunk.size() >= size)
+			m_streams.erase(path);
+	}
+
+	// the caller reuses the chunk's buffer, so the queue holds a copy
+	Queue({ std::move(path), File(std::string(), std::string(chunk)), nullptr, std::move(stream), offset, size });
+}
+
+void FileWriter::Queue(Job job)
+{
+	const auto size = job.file.GetContentsView().size();
+
+	{
+		std::unique_lock<std::mutex> lock(m_mutex, std::defer_lock);
+
+		// the lock and the wait for room, which is where writes hold up decryption
+		{
+			const Trace::Span span("queue write", job.path);
+			lock.lock();
+
+			// a file larger than the whole queue still goes through once the queue is empty
+			m_spaceReady.wait(lock, [this, size] { return m_queuedBytes == 0 || m_queuedBytes + size <= m_maxQueuedBytes; });
+		}
+
+		m_queuedBytes += size;
+		m_jobs.push_back(std::move(job));
+	}
+	m_jobReady.notify_one();
+}
+
+size_t FileWriter::Wait()
+{
+	std::unique_lock<std::mutex> lock(m_mutex);
+	m_jobsDone.wait(lock, [this] { return m_jobs.empty() == true && m_activeJobs == 0; });
+
+	const auto failures = m_failures;
+	m_failures = 0;
+	return failures;
+}
+
+void FileWriter::WriterLoop()
+{
+	while (true)
+	{
+		std::unique_lock<std::mutex> lock(m_mutex);
+		m_jobReady.wait(lock, [this] { return m_stopping == true || m_jobs.empty() == false; });
+
+		// only stop once the queue has drained
+		if (m_jobs.empty() == true)
+			return;
+
+		auto job = std::move(m_jobs.front());
+		m_jobs.pop_front();
+		++m_activeJobs;
+
+		lock.unlock();
+
+		const auto size = job.file.GetContentsView().size();
+		const auto ec = RunJob(std::move(job));
+
+		lock.lock();
+
+		m_queuedBytes -= size;
+		--m_activeJobs;
+
+		if (ec != ErrorCode_SUCCESS)
+			++m_failures;
+
+		m_spaceReady.notify_all();
+
+		if (m_jobs.empty() == true && m_activeJobs == 0)
+			m_jobsDone.notify_all();
+	}
+}
+
+ErrorCode FileWriter::RunJob(Job job)
+{
+	ErrorCode ec;
+	{
+		const Trace::Span span("write file", job.path);
+		ec = WriteJob(job);
+	}
+
+	auto callback = std::move(job.callback);
+
+	if (job.stream != nullptr)
+	{
+		std::lock_guard<std::mutex> lock(job.stream->mutex);
+
+		if (job.stream->ec == ErrorCode_SUCCESS)
+			job.stream->ec = ec;
+
+		job.stream->remaining -= job.file.GetContentsView().size();
+
+		// only the last piece to be written reports the file
+		if (job.stream->remaining != 0)
+			return ErrorCode_SUCCESS;
+
+		ec = job.stream->ec;
+		callback = std::move(job.stream->callback);
+	}
+
+	if (callback != nullptr)
+		callback(job.path, ec);
+
+	// the job goes out of scope here, which drops our reference to the contents before we make room for more
+	return ec;
+}
+
+ErrorCode FileWriter::WriteJob(const Job& job)
+{
+	if (CreateParent(job.path) == false)
+		return ErrorCode_FILENOTOPEN;
+
+	const auto contents = job.file.GetContentsView();
+
+	if (job.stream == nullptr)
+		return WriteAt(job.path, contents, 0, job.size, true);
+
+	// every other piece waits until the file exists, then opens it as it is
+	ErrorCode ec;
+	auto created = false;
+
+	std::call_once(job.stream->created, [&]
+	{
+		ec = WriteAt(job.path, contents, job.offset, job.size, true);
+		created = true;
+	});
+
+	if (created == false)
+		ec = WriteAt(job.path, contents, job.offset, job.size, false);
+
+	return ec;
+}
+
+bool FileWriter::CreateParent(const std::string& path)
+{
+	const auto parent = std::filesystem::path(path).parent_path();
+
+	if (parent.empty() == true)
+		return true;
+
+	std::lock_guard<std::mutex> lock(m_directoryMutex);
+
+	const auto directory = parent.string();
+	if (m_directories.count(directory) != 0)
+		return true;
+
+	std::error_code fsError;
+	std::filesystem::create_directories(parent, fsError);
+
+	if (fsError)
+		return false;
+
+	m_directories.insert(directory);
+	return true;
+}
@@ -0,0 +1,151 @@
+#include <Framework/Files/MappedFile.h>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+using Framework::ErrorCode;
+using Framework::Files::MappedFile;
+
+MappedFile::MappedFile(const std::string& fileName)
+{
+	const auto ec = Map(fileName);
+
+	if (ec != ErrorCode_SUCCESS)
+		throw ec;
+}
+
+MappedFile::MappedFile(const std::string& fileName, ErrorCode& ec) noexcept
+{
+	ec = Map(fileName);
+}
+
+MappedFile::~MappedFile()
+{
+	Unmap();
+}
+
+const char* MappedFile::GetData() const noexcept
+{
+	return m_data;
+}
+
+size_t MappedFile::GetSize() const noexcept
+{
+	return m_size;
+}
+
+#ifdef _WIN32
+ErrorCode MappedFile::Map(const std::string& fileName) noexcept
+{
+	// sharing delete lets a mapped image of an ArchiveCache be moved aside and replaced
+	const auto file = CreateFileA(fileName.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE, nullptr,
+		OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+
+	if (file == INVALID_HANDLE_VALUE)
+		return ErrorCode_FILENOTFOUND;
+
+	m_file = file;
+
+	LARGE_INTEGER size;
+	if (GetFileSizeEx(m_file, &size) == FALSE)
+	{
+		Unmap();
+		return ErrorCode_FILENOTOPEN;
+	}
+
+	m_size = static_cast<size_t>(size.QuadPart);
+
+	// empty files cannot be mapped, but they are still valid
+	if (m_size == 0)
+		return ErrorCode_SUCCESS;
+
+	m_mapping = CreateFileMappingA(m_file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if (m_mapping == nullptr)
+	{
+		Unmap();
+		return ErrorCode_FILENOTOPEN;
+	}
+
+	m_data = static_cast<const char*>(MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0));
+	if (m_data == nullptr)
+	{
+		Unmap();
+		return ErrorCode_FILENOTOPEN;
+	}
+
+	return ErrorCode_SUCCESS;
+}
+
+void MappedFile::Unmap() noexcept
+{
+	if (m_data != nullptr)
+		UnmapViewOfFile(m_data);
+
+	if (m_mapping != nullptr)
+		CloseHandle(m_mapping);
+
+	if (m_file != nullptr)
+		CloseHandle(m_file);
+
+	m_data = nullptr;
+	m_size = 0;
+	m_mapping = nullptr;
+	m_file = nullptr;
+}
+#else
+ErrorCode MappedFile::Map(const std::string& fileName) noexcept
+{
+	m_file = open(fileName.c_str(), O_RDONLY);
+
+	if (m_file == -1)
+		return ErrorCode_FILENOTFOUND;
+
+	struct stat info;
+	if (fstat(m_file, &info) != 0)
+	{
+		Unmap();
+		return ErrorCode_FILENOTOPEN;
+	}
+
+	m_size = static_cast<size_t>(info.st_size);
+
+	// empty files cannot be mapped, but they are still valid
+	if (m_size == 0)
+		return ErrorCode_SUCCESS;
+
+	void* data = mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, m_file, 0);
+	if (data == MAP_FAILED)
+	{
+		Unmap();
+		return ErrorCode_FILENOTOPEN;
+	}
+
+	// we walk the archive front to back, let the kernel read ahead
+	madvise(data, m_size, MADV_SEQUENTIAL);
+
+	m_data = static_cast<const char*>(data);
+
+	return ErrorCode_SUCCESS;
+}
+
+void MappedFile::Unmap() noexcept
+{
+	if (m_data != nullptr)
+		munmap(const_cast<char*>(m_data), m_size);
+
+	if (m_file != -1)
+		close(m_file);
+
+	m_data = nullptr;
+	m_size = 0;
+	m_file = -1;
+}
+#endif
@@ -0,0 +1,26 @@
+#ifndef FRAMEWORK_FROMCHARS_H_
+#define FRAMEWORK_FROMCHARS_H_
+
+/*
+ *	FromChars
+ *	10/18/26 06:40
+ */
+
+#include <charconv>
+#include <string_view>
+
+// internal to the framework, not part of its include directory
+namespace Framework
+{
+	// std::from_chars over the whole of text, which also takes the leading plus sign from_chars does not
+	template <typename T>
+	std::from_chars_result FromChars(std::string_view text, T& value) noexcept
+	{
+		if (text.empty() == false && text.front() == '+')
+			text.remove_prefix(1);
+
+		return std::from_chars(text.data(), text.data() + text.size(), value);
+	}
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,298 @@
+#include <Framework/GearingSearch.h>
+
+#include <Framework/ThreadPool.h>
+#include <Framework/Trace.h>
+
+#include <algorithm>
+#include <functional>
+#include <limits>
+
+using Framework::AccelerationSimulator;
+using Framework::Car;
+using Framework::GearingSearch;
+using Framework::Trace;
+
+namespace
+{
+	// the number of speeds the force is averaged over
+	constexpr size_t SPEED_SAMPLES = 128;
+
+	constexpr double PI = 3.14159265358979323846;
+
+	// returns every value of a range, ascending
+	std::vector<float> GetValues(const GearingSearch::Range& range)
+	{
+		std::vector<float> values;
+
+		if (range.step <= 0.f || range.max < range.min)
+		{
+			values.push_back(range.min);
+			return values;
+		}
+
+		// the small margin keeps max in the range despite rounding
+		const auto count = static_cast<size_t>((range.max - range.min) / range.step + 1e-4f) + 1;
+		for (size_t i = 0; i < count; ++i)
+			values.push_back(range.min + i * range.step);
+
+		return values;
+	}
+
+	// returns the mean of the larger of a and b at every speed
+	double GetAverage(const float* a, const float* b)
+	{
+		float sum = 0.f;
+		for (size_t i = 0; i < SPEED_SAMPLES; ++i)
+			sum += std::max(a[i], b[i]);
+
+		return sum / SPEED_SAMPLES;
+	}
+}
+
+GearingSearch::GearingSearch(const Car& car, const Range& gearRange, const Range& finalRange, double minSpeed, double maxSpeed, size_t threadCount)
+	: m_car(car), m_threadCount(threadCount), m_gearValues(GetValues(gearRange)), m_finalValues(GetValues(finalRange))
+{
+	const auto& torqueCurve = car.GetTorqueCurve();
+	const auto radius = car.GetTyreRadius();
+
+	// wheel revolutions per minute at every speed
+	std::vector<double> wheelRPMs(SPEED_SAMPLES);
+	for (size_t i = 0; i < SPEED_SAMPLES; ++i)
+	{
+		const auto speed = (minSpeed + (maxSpeed - minSpeed) * i / (SPEED_SAMPLES - 1)) / 3.6;
+		wheelRPMs[i] = speed * 60.0 / (2.0 * PI * radius);
+	}
+
+	m_forces.resize(m_finalValues.size() * m_gearValues.size() * SPEED_SAMPLES);
+	m_bestForces.resize(m_forces.size());
+
+	std::vector<FloatCurve::Ref_t> rpms(SPEED_SAMPLES);
+	std::vector<FloatCurve::Value_t> torques(SPEED_SAMPLES);
+
+	for (size_t finalIndex = 0; finalIndex < m_finalValues.size(); ++finalIndex)
+	{
+		for (size_t ratioIndex = 0; ratioIndex < m_gearValues.size(); ++ratioIndex)
+		{
+			const auto ratio = m_gearValues[ratioIndex] * m_finalValues[finalIndex];
+
+			// the clutch slips until the engine reaches the curve, and the limiter cuts it at redline
+			for (size_t i = 0; i < SPEED_SAMPLES; ++i)
+				rpms[i] = std::max(torqueCurve.GetMinRef(), static_cast<FloatCurve::Ref_t>(wheelRPMs[i] * ratio));
+
+			// ascending, so this is one pass over the curve
+			torqueCurve.GetValue(rpms.data(), torques.data(), SPEED_SAMPLES);
+
+			auto* forces = const_cast<float*>(GetForces(finalIndex, ratioIndex));
+			auto* bestForces = const_cast<float*>(GetBestForces(finalIndex, ratioIndex));
+			const auto* smallerBest = (ratioIndex == 0) ? nullptr : GetBestForces(finalIndex, ratioIndex - 1);
+
+			for (size_t i = 0; i < SPEED_SAMPLES; ++i)
+			{
+				forces[i] = (rpms[i] > car.GetRedline()) ? 0.f : torques[i] * ratio / radius;
+				bestForces[i] = (smallerBest == nullptr) ? forces[i] : std::max(forces[i], smallerBest[i]);
+			}
+		}
+	}
+
+	// a gear never adds more over a gearing than it adds over the gear just above it, and gears add at most the
+	// sum of what each adds alone. that bounds a branch far more tightly than the best forces when few gears are left
+	const auto ratioCount = m_gearValues.size();
+	const auto gears = car.GetGearRatios().size();
+
+	m_gains.resize(m_finalValues.size() * ratioCount * ratioCount);
+	m_topGains.resize(m_finalValues.size() * ratioCount * (gears + 1));
+
+	std::vector<float> gains;
+
+	for (size_t finalIndex = 0; finalIndex < m_finalValues.size(); ++finalIndex)
+	{
+		for (size_t ratioIndex = 0; ratioIndex < ratioCount; ++ratioIndex)
+		{
+			const auto* forces = GetForces(finalIndex, ratioIndex);
+			auto* ratioGains = &m_gains[(finalIndex * ratioCount + ratioIndex) * ratioCount];
+
+			for (size_t smallerIndex = 0; smallerIndex < ratioIndex; ++smallerIndex)
+			{
+				const auto* smallerForces = GetForces(finalIndex, smallerIndex);
+
+				float gain = 0.f;
+				for (size_t i = 0; i < SPEED_SAMPLES; ++i)
+					gain += std::max(0.f, smallerForces[i] - forces[i]);
+
+				ratioGains[smallerIndex] = gain;
+			}
+
+			gains.assign(ratioGains, ratioGains + ratioIndex);
+			std::sort(gains.begin(), gains.end(), std::greater<float>());
+
+			auto* topGains = &m_topGains[(finalIndex * ratioCount + ratioIndex) * (gears + 1)];
+			topGains[0] = 0.f;
+
+			for (size_t count = 1; count <= gears; ++count)
+				topGains[count] = topGains[count - 1] + ((count <= gains.size()) ? gains[count - 1] : 0.f);
+		}
+	}
+}
+
+GearingSearch::Candidates_t GearingSearch::Search(size_t count) const
+{
+	const Trace::Span span("search gearings");
+
+	Results results;
+	results.count = count;
+	results.threshold = -std::numeric_limits<double>::infinity();
+
+	const auto gears = m_car.GetGearRatios().size();
+
+	// the other gears need a smaller ratio each
+	if (count == 0 || gears == 0 || m_gearValues.size() < gears)
+		return Candidates_t();
+
+	// one branch for every final and first gear ratio
+	const auto firstCount = m_gearValues.size() - (gears - 1);
+
+	ThreadPool pool(m_threadCount);
+	pool.ParallelFor(m_finalValues.size() * firstCount, [&](size_t branch)
+	{
+		// larger first gears first, they tend to find good gearings early and prune more
+		SearchBranch(branch / firstCount, m_gearValues.size() - 1 - branch % firstCount, results);
+	});
+
+	return results.candidates;
+}
+
+void GearingSearch::Simulate(Candidates_t& candidates) const
+{
+	const Trace::Span span("simulate gearings");
+
+	ThreadPool pool(m_threadCount);
+	pool.ParallelFor(candidates.size(), [&](size_t index)
+	{
+		auto& candidate = candidates[index];
+
+		auto car = m_car;
+		car.SetGearing(candidate.gearRatios, candidate.finalRatio);
+
+		const AccelerationSimulator simulator(car);
+		candidate.times = simulator.Optimize(candidate.shiftPoints);
+	});
+
+	// cars that do not reach 200 km/h go last
+	const auto score = [](const Candidate& candidate)
+	{
+		return (candidate.times.time200 >= 0.0) ? candidate.times.time200 : std::numeric_limits<double>::infinity();
+	};
+
+	std::stable_sort(candidates.begin(), candidates.end(), [&](const Candidate& lhs, const Candidate& rhs) { return score(lhs) < score(rhs); });
+}
+
+void GearingSearch::SearchBranch(size_t finalIndex, size_t firstIndex, Results& results) const
+{
+	const Trace::Span span("search branch");
+
+	const auto gears = m_car.GetGearRatios().size();
+
+	// envelopes[depth] is the best force of the first depth + 1 gears at every speed
+	std::vector<float> envelopes(gears * SPEED_SAMPLES);
+	std::vector<size_t> indices(gears);
+
+	const auto* forces = GetForces(finalIndex, firstIndex);
+	std::copy(forces, forces + SPEED_SAMPLES, envelopes.begin());
+	indices[0] = firstIndex;
+
+	SearchGear(finalIndex, 1, envelopes, indices, results);
+}
+
+void GearingSearch::SearchGear(size_t finalIndex, size_t depth, std::vector<float>& envelopes, std::vector<size_t>& indices, Results& results) const
+{
+	const auto gears = indices.size();
+	const auto* envelope = envelopes.data() + (depth - 1) * SPEED_SAMPLES;
+
+	float envelopeSum = 0.f;
+	for (size_t i = 0; i < SPEED_SAMPLES; ++i)
+		envelopeSum += envelope[i];
+
+	if (depth == gears)
+	{
+		const auto averageForce = static_cast<double>(envelopeSum) / SPEED_SAMPLES;
+
+		if (averageForce > results.threshold.load(std::memory_order_relaxed))
+			Offer(finalIndex, indices, averageForce, results);
+
+		return;
+	}
+
+	// the gears after this one need a smaller ratio each
+	const auto gearsLeft = gears - depth - 1;
+	const auto previousIndex = indices[depth - 1];
+	auto* next = envelopes.data() + depth * SPEED_SAMPLES;
+
+	for (auto ratioIndex = previousIndex; ratioIndex-- > gearsLeft;)
+	{
+		const auto threshold = results.threshold.load(std::memory_order_relaxed);
+
+		// what this ratio adds over the gear above, and what the gears left could add over it
+		const auto gainBound = envelopeSum + GetGain(finalIndex, previousIndex, ratioIndex) + GetTopGains(finalIndex, ratioIndex, gearsLeft);
+
+		if (static_cast<double>(gainBound) / SPEED_SAMPLES <= threshold)
+			continue;
+
+		const auto* forces = GetForces(finalIndex, ratioIndex);
+		for (size_t i = 0; i < SPEED_SAMPLES; ++i)
+			next[i] = std::max(envelope[i], forces[i]);
+
+		// the best the gears left could add is the best of every smaller ratio
+		if (gearsLeft != 0 && GetAverage(next, GetBestForces(finalIndex, ratioIndex - 1)) <= threshold)
+			continue;
+
+		indices[depth] = ratioIndex;
+		SearchGear(finalIndex, depth + 1, envelopes, indices, results);
+	}
+}
+
+void GearingSearch::Offer(size_t finalIndex, const std::vector<size_t>& indices, double averageForce, Results& results) const
+{
+	std::lock_guard<std::mutex> lock(results.mutex);
+
+	// another branch may have raised the bar meanwhile
+	if (averageForce <= results.threshold.load(std::memory_order_relaxed))
+		return;
+
+	Candidate candidate;
+	for (const auto index : indices)
+		candidate.gearRatios.push_back(m_gearValues[index]);
+	candidate.finalRatio = m_finalValues[finalIndex];
+	candidate.averageForce = averageForce;
+
+	auto& candidates = results.candidates;
+	const auto position = std::find_if(candidates.begin(), candidates.end(), [&](const Candidate& other) { return other.averageForce < averageForce; });
+	candidates.insert(position, std::move(candidate));
+
+	if (candidates.size() > results.count)
+		candidates.pop_back();
+
+	// once the list is full, only better gearings than the last one matter
+	if (candidates.size() == results.count)
+		results.threshold.store(candidates.back().averageForce, std::memory_order_relaxed);
+}
+
+const float* GearingSearch::GetForces(size_t finalIndex, size_t ratioIndex) const noexcept
+{
+	return m_forces.data() + (finalIndex * m_gearValues.size() + ratioIndex) * SPEED_SAMPLES;
+}
+
+const float* GearingSearch::GetBestForces(size_t finalIndex, size_t ratioIndex) const noexcept
+{
+	return m_bestForces.data() + (finalIndex * m_gearValues.size() + ratioIndex) * SPEED_SAMPLES;
+}
+
+
+float GearingSearch::GetGain(size_t finalIndex, size_t ratioIndex, size_t smallerIndex) const noexcept
+{
+	return m_gains[(finalIndex * m_gearValues.size() + ratioIndex) * m_gearValues.size() + smallerIndex];
+}
+
+float GearingSearch::GetTopGains(size_t finalIndex, size_t ratioIndex, size_t gearCount) const noexcept
+{
+	return m_topGains[(finalIndex * m_gearValues.size() + ratioIndex) * (m_car.GetGearRatios().size() + 1) + gearCount];
+}
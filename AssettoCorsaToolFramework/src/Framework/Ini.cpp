@@ -0,0 +1,199 @@
+#include <Framework/Ini.h>
+
+#include <Framework/Trace.h>
+#include "FromChars.h"
+
+#include <algorithm>
+#include <functional>
+#include <type_traits>
+
+using Framework::ErrorCode;
+using Framework::Ini;
+using Framework::Result;
+using Framework::Trace;
+
+namespace
+{
+	constexpr Ini::View_t WHITESPACE = " \t\r\n\v\f";
+
+	// removes whitespace from both ends
+	Ini::View_t Trim(Ini::View_t text)
+	{
+		const auto start = text.find_first_not_of(WHITESPACE);
+		if (start == Ini::View_t::npos)
+			return Ini::View_t();
+
+		const auto end = text.find_last_not_of(WHITESPACE);
+		return text.substr(start, end - start + 1);
+	}
+
+	// orders entries by section, then key
+	template <typename Entry>
+	bool EntryLess(const Entry& lhs, const Entry& rhs)
+	{
+		if (lhs.section != rhs.section)
+			return lhs.section < rhs.section;
+
+		return lhs.key < rhs.key;
+	}
+
+	// orders entries by section, then key, then where they are in the file
+	template <typename Entry>
+	bool EntryBefore(const Entry& lhs, const Entry& rhs)
+	{
+		if (EntryLess(lhs, rhs) == true)
+			return true;
+
+		if (EntryLess(rhs, lhs) == true)
+			return false;
+
+		// every key is a view into the same contents, so this is file order
+		return std::less<const char*>()(lhs.key.data(), rhs.key.data());
+	}
+}
+
+Ini::Ini(View_t contents)
+{
+	Parse(contents);
+}
+
+void Ini::Parse(View_t contents)
+{
+	const Trace::Span span("parse ini");
+
+	// keeps its capacity, so parsing again into the same index does not allocate unless the file has more lines
+	m_entries.clear();
+
+	// the only allocation of a parse, every line is at most one key
+	m_entries.reserve(std::count(contents.begin(), contents.end(), '\n') + 1);
+
+	View_t section;
+
+	while (contents.empty() == false)
+	{
+		// split off the next line
+		const auto lineEnd = contents.find('\n');
+		const auto line = Trim(contents.substr(0, lineEnd));
+		contents.remove_prefix((lineEnd == View_t::npos) ? contents.size() : lineEnd + 1);
+
+		// skip empty lines and comments
+		if (line.empty() == true || line.front() == ';')
+			continue;
+
+		if (line.front() == '[')
+		{
+			// a section without its end is not a section
+			if (line.back() == ']')
+				section = line.substr(1, line.size() - 2);
+
+			continue;
+		}
+
+		const auto assignPos = line.find('=');
+
+		// weed out lines without a key
+		if (assignPos == 0 || assignPos == View_t::npos)
+			continue;
+
+		// values end at the first whitespace or comment
+		auto value = Trim(line.substr(assignPos + 1));
+		value = value.substr(0, value.find_first_of(" \t;"));
+
+		m_entries.push_back({ section, Trim(line.substr(0, assignPos)), value });
+	}
+
+	// file order breaks ties, so the first of a repeated key stays in front without the buffer stable_sort takes
+	std::sort(m_entries.begin(), m_entries.end(), EntryBefore<Entry>);
+}
+
+bool Ini::HasSection(View_t section) const noexcept
+{
+	const auto it = std::lower_bound(m_entries.begin(), m_entries.end(), section,
+		[](const Entry& entry, View_t section) { return entry.section < section; });
+
+	return it != m_entries.end() && it->section == section;
+}
+
+bool Ini::HasKey(View_t section, View_t key) const noexcept
+{
+	return FindEntry(section, key) != nullptr;
+}
+
+template <typename T>
+Result<T> Ini::TryGetValue(View_t section, View_t key) const noexcept
+{
+	const auto entry = FindEntry(section, key);
+
+	if (entry == nullptr)
+		return ErrorCode(ErrorCode_FORMAT);
+
+	if constexpr (std::is_same_v<T, View_t>)
+	{
+		return entry->value;
+	}
+	else
+	{
+		const auto text = entry->value;
+
+		// the whole value has to be the number
+		T value;
+		const auto result = Framework::FromChars(text, value);
+
+		if (result.ec != std::errc() || result.ptr != text.data() + text.size())
+			return ErrorCode(ErrorCode_FORMAT);
+
+		return value;
+	}
+}
+
+template <typename T>
+T Ini::GetValue(View_t section, View_t key) const
+{
+	return TryGetValue<T>(section, key).GetValue();
+}
+
+template <typename T>
+T Ini::GetValue(View_t section, View_t key, ErrorCode& ec) const noexcept
+{
+	const auto result = TryGetValue<T>(section, key);
+
+	if (result.HasValue() == false)
+	{
+		ec = result.GetError();
+		return T();
+	}
+
+	return result.GetValue();
+}
+
+const Ini::Entry* Ini::FindEntry(View_t section, View_t key) const noexcept
+{
+	const Entry target = { section, key, View_t() };
+	const auto it = std::lower_bound(m_entries.begin(), m_entries.end(), target, EntryLess<Entry>);
+
+	if (it == m_entries.end() || it->section != section || it->key != key)
+		return nullptr;
+
+	return &*it;
+}
+
+template Ini::View_t Ini::GetValue<Ini::View_t>(View_t, View_t) const;
+template int32_t Ini::GetValue<int32_t>(View_t, View_t) const;
+template uint32_t Ini::GetValue<uint32_t>(View_t, View_t) const;
+template int64_t Ini::GetValue<int64_t>(View_t, View_t) const;
+template float Ini::GetValue<float>(View_t, View_t) const;
+template double Ini::GetValue<double>(View_t, View_t) const;
+
+template Ini::View_t Ini::GetValue<Ini::View_t>(View_t, View_t, ErrorCode&) const noexcept;
+template int32_t Ini::GetValue<int32_t>(View_t, View_t, ErrorCode&) const noexcept;
+template uint32_t Ini::GetValue<uint32_t>(View_t, View_t, ErrorCode&) const noexcept;
+template int64_t Ini::GetValue<int64_t>(View_t, View_t, ErrorCode&) const noexcept;
+template float Ini::GetValue<float>(View_t, View_t, ErrorCode&) const noexcept;
+template double Ini::GetValue<double>(View_t, View_t, ErrorCode&) const noexcept;
+
+template Result<Ini::View_t> Ini::TryGetValue<Ini::View_t>(View_t, View_t) const noexcept;
+template Result<int32_t> Ini::TryGetValue<int32_t>(View_t, View_t) const noexcept;
+template Result<uint32_t> Ini::TryGetValue<uint32_t>(View_t, View_t) const noexcept;
+template Result<int64_t> Ini::TryGetValue<int64_t>(View_t, View_t) const noexcept;
+template Result<float> Ini::TryGetValue<float>(View_t, View_t) const noexcept;
+template Result<double> Ini::TryGetValue<double>(View_t, View_t) const noexcept;
@@ -0,0 +1,32 @@
+#include <Framework/Json.h>
+
+#include <cstdio>
+
+using Framework::Json;
+
+std::string Json::Escape(std::string_view text)
+{
+	std::string escaped;
+	escaped.reserve(text.size());
+
+	for (const auto c : text)
+	{
+		if (c == '"' || c == '\\')
+		{
+			escaped += '\\';
+			escaped += c;
+		}
+		else if (static_cast<unsigned char>(c) < 0x20)
+		{
+			char code[8];
+			snprintf(code, sizeof(code), "\\u%04x", c);
+			escaped += code;
+		}
+		else
+		{
+			escaped += c;
+		}
+	}
+
+	return escaped;
+}
@@ -0,0 +1,154 @@
+#include <Framework/ShiftSolver.h>
+
+#include <Framework/Trace.h>
+
+#include <algorithm>
+#include <iterator>
+#include <vector>
+
+using Framework::FloatCurve;
+using Framework::ShiftSolver;
+using Framework::Trace;
+
+namespace
+{
+	// a piece of the torque curve, where torque is slope * rpm + offset
+	struct TorqueLine
+	{
+		double slope;
+		double offset;
+	};
+
+	// returns the piece of the torque curve that starts at or below rpm. outside of the curve, torque is 0
+	TorqueLine GetTorqueLine(const FloatCurve& torqueCurve, double rpm)
+	{
+		const auto& refs = torqueCurve.GetRefs();
+		const auto& values = torqueCurve.GetValues();
+
+		const auto above = static_cast<size_t>(std::upper_bound(refs.begin(), refs.end(), rpm) - refs.begin());
+
+		if (above == 0 || above == refs.size())
+			return { 0.0, 0.0 };
+
+		const auto below = above - 1;
+		const auto slope = (values[above] - values[below]) / static_cast<double>(refs[above] - refs[below]);
+
+		return { slope, values[below] - slope * refs[below] };
+	}
+
+	// returns the torque at rpm, the same as the curve but without rounding rpm
+	double GetTorque(const FloatCurve& torqueCurve, double rpm)
+	{
+		// the last point is the only one without a piece above it
+		if (rpm == torqueCurve.GetMaxRef())
+			return torqueCurve.GetValues().back();
+
+		const auto line = GetTorqueLine(torqueCurve, rpm);
+		return line.slope * rpm + line.offset;
+	}
+}
+
+ShiftSolver::ShiftSolver(const Car& car)
+	: m_car(car)
+{
+}
+
+// the wheel torque of both gears is linear between the points of the curve, scaled by each ratio, so every piece is
+// solved in closed form while walking down from redline
+bool ShiftSolver::Solve(size_t gear, double& shiftRPM) const
+{
+	const auto& torqueCurve = m_car.GetTorqueCurve();
+	const auto& gearRatios = m_car.GetGearRatios();
+	const auto redline = m_car.GetRedline();
+
+	if (gear + 1 >= gearRatios.size() || torqueCurve.GetRefs().empty() == true)
+		return false;
+
+	const auto currRatio = gearRatios[gear];
+	const auto nextRatio = gearRatios[gear + 1];
+
+	if (currRatio <= 0.f || nextRatio <= 0.f)
+		return false;
+
+	// the rpm of the next gear, for each rpm in the current gear
+	const double speedRatio = nextRatio / static_cast<double>(currRatio);
+
+	// wheel torque in the current gear, less the next gear's, at rpm
+	const auto gain = [&](double rpm)
+	{
+		return currRatio * GetTorque(torqueCurve, rpm) - nextRatio * GetTorque(torqueCurve, rpm * speedRatio);
+	};
+
+	if (gain(redline) > 0.0)
+	{
+		shiftRPM = redline;
+		return true;
+	}
+
+	// the gain bends where either gear crosses a point of the curve
+	const auto& refs = torqueCurve.GetRefs();
+
+	std::vector<double> currPoints(refs.begin(), refs.end());
+	std::vector<double> nextPoints;
+	nextPoints.reserve(refs.size());
+	for (const auto ref : refs)
+		nextPoints.push_back(ref / speedRatio);
+
+	std::vector<double> points;
+	points.reserve(currPoints.size() + nextPoints.size() + 1);
+	points.push_back(0.0);
+	std::merge(currPoints.begin(), currPoints.end(), nextPoints.begin(), nextPoints.end(), std::back_inserter(points));
+
+	// walk down every piece between redline and 0
+	double top = redline;
+	for (auto it = points.rbegin(); it != points.rend(); ++it)
+	{
+		const auto bottom = *it;
+		if (bottom >= top)
+			continue;
+
+		// the gain is linear on this piece, take it from the middle so neither end is on the wrong side of a point
+		const auto middle = (top + bottom) / 2;
+		const auto curr = GetTorqueLine(torqueCurve, middle);
+		const auto next = GetTorqueLine(torqueCurve, middle * speedRatio);
+
+		const auto slope = currRatio * curr.slope - nextRatio * next.slope * speedRatio;
+		const auto offset = currRatio * curr.offset - nextRatio * next.offset;
+
+		// the gain jumped at the top, where either gear left the curve
+		if (slope * top + offset > 0.0)
+		{
+			shiftRPM = top;
+			return true;
+		}
+
+		// the gain crosses zero within this piece
+		if (slope * bottom + offset > 0.0)
+		{
+			shiftRPM = -offset / slope;
+			return true;
+		}
+
+		top = bottom;
+	}
+
+	return false;
+}
+
+ShiftSolver::ShiftPoints_t ShiftSolver::Solve() const
+{
+	const Trace::Span span("solve shift points");
+
+	ShiftPoints_t shiftPoints;
+
+	for (size_t gear = 0; gear + 1 < m_car.GetGearRatios().size(); ++gear)
+	{
+		double shiftRPM;
+		if (Solve(gear, shiftRPM) == false)
+			shiftRPM = -1.0;
+
+		shiftPoints.push_back(shiftRPM);
+	}
+
+	return shiftPoints;
+}
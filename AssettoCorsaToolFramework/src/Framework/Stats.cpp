@@ -0,0 +1,166 @@
+#include <Framework/Stats.h>
+
+#include <iomanip>
+#include <ios>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <vector>
+
+using Framework::Stats;
+
+std::atomic<bool> Stats::s_enabled{ false };
+
+namespace
+{
+	// the counters of one thread. only that thread writes them, so they are never contended
+	struct Block
+	{
+		std::array<std::atomic<uint64_t>, Stats::COUNTER_COUNT> values{};
+	};
+
+	// every block ever handed out. blocks of threads that exited are handed to new threads, with their counts
+	struct Registry
+	{
+		std::mutex mutex;
+		std::vector<std::unique_ptr<Block>> blocks;
+		std::vector<Block*> freeBlocks;
+	};
+
+	Registry& GetRegistry()
+	{
+		static Registry registry;
+		return registry;
+	}
+
+	// holds a thread's block, and gives it back when the thread exits
+	struct BlockOwner
+	{
+		BlockOwner()
+		{
+			auto& registry = GetRegistry();
+			std::lock_guard<std::mutex> lock(registry.mutex);
+
+			if (registry.freeBlocks.empty() == false)
+			{
+				block = registry.freeBlocks.back();
+				registry.freeBlocks.pop_back();
+				return;
+			}
+
+			registry.blocks.push_back(std::make_unique<Block>());
+			block = registry.blocks.back().get();
+		}
+
+		~BlockOwner()
+		{
+			auto& registry = GetRegistry();
+			std::lock_guard<std::mutex> lock(registry.mutex);
+
+			registry.freeBlocks.push_back(block);
+		}
+
+		Block* block;
+	};
+
+	Block& GetBlock()
+	{
+		thread_local BlockOwner owner;
+		return *owner.block;
+	}
+}
+
+void Stats::SetEnabled(bool enabled) noexcept
+{
+	s_enabled.store(enabled, std::memory_order_relaxed);
+}
+
+Stats::Values_t Stats::GetValues() noexcept
+{
+	Values_t values{};
+
+	auto& registry = GetRegistry();
+	std::lock_guard<std::mutex> lock(registry.mutex);
+
+	for (const auto& block : registry.blocks)
+	{
+		for (size_t i = 0; i < values.size(); ++i)
+			values[i] += block->values[i].load(std::memory_order_relaxed);
+	}
+
+	return values;
+}
+
+void Stats::Reset() noexcept
+{
+	auto& registry = GetRegistry();
+	std::lock_guard<std::mutex> lock(registry.mutex);
+
+	for (const auto& block : registry.blocks)
+	{
+		for (auto& value : block->values)
+			value.store(0, std::memory_order_relaxed);
+	}
+}
+
+const char* Stats::GetName(Counter_t counter) noexcept
+{
+	switch (counter)
+	{
+	case COUNTER_BYTESREAD:
+		return "bytes read";
+	case COUNTER_ENTRIESDECRYPTED:
+		return "entries decrypted";
+	case COUNTER_BYTESDECRYPTED:
+		return "bytes decrypted";
+	case COUNTER_DECRYPTTIME:
+		return "decrypt time (ns)";
+	case COUNTER_LOOKUPS:
+		return "lookups";
+	case COUNTER_LOOKUPTIME:
+		return "lookup time (ns)";
+	case COUNTER_LUTPOINTS:
+		return "LUT points parsed";
+	case COUNTER_CURVEEVALUATIONS:
+		return "curve evaluations";
+	case COUNTER_CACHEFAILURES:
+		return "cache store failures";
+	default:
+		return "unknown";
+	}
+}
+
+void Stats::Print(std::ostream& out)
+{
+	const auto values = GetValues();
+
+	// the caller's stream keeps its own formatting once we are done
+	std::ios state(nullptr);
+	state.copyfmt(out);
+
+	for (size_t i = 0; i < values.size(); ++i)
+		out << std::left << std::setw(24) << GetName(static_cast<Counter_t>(i)) << values[i] << '\n';
+
+	// the time is summed over threads, so this is the throughput of one thread
+	if (values[COUNTER_DECRYPTTIME] != 0)
+	{
+		out << std::left << std::setw(24) << "decrypt rate (MB/s)" << std::fixed << std::setprecision(1)
+			<< values[COUNTER_BYTESDECRYPTED] * 1e3 / values[COUNTER_DECRYPTTIME] << '\n';
+	}
+
+	if (values[COUNTER_LOOKUPS] != 0)
+	{
+		out << std::left << std::setw(24) << "lookup latency (ns)" << std::fixed << std::setprecision(1)
+			<< static_cast<double>(values[COUNTER_LOOKUPTIME]) / values[COUNTER_LOOKUPS] << '\n';
+	}
+
+	out.copyfmt(state);
+}
+
+void Stats::AddEnabled(Counter_t counter, uint64_t value) noexcept
+{
+	auto& slot = GetBlock().values[counter];
+
+	// only this thread writes the slot, so there is no need for a locked add
+	slot.store(slot.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+}
@@ -0,0 +1,249 @@
+#include <Framework/ThreadPool.h>
+
+#include <Framework/Error.h>
+#include <Framework/Trace.h>
+
+#include <algorithm>
+
+using Framework::ErrorCode;
+using Framework::ThreadPool;
+using Framework::Trace;
+
+namespace
+{
+	// the pool and queue of the worker running on this thread, if any
+	thread_local const ThreadPool* t_pool = nullptr;
+	thread_local size_t t_index = 0;
+}
+
+ThreadPool::ThreadPool(size_t threadCount)
+	: m_queued(0), m_pending(0), m_nextQueue(0)
+{
+	if (threadCount == 0)
+		threadCount = std::max(1u, std::thread::hardware_concurrency());
+
+	m_queues.reserve(threadCount);
+	for (size_t i = 0; i < threadCount; ++i)
+		m_queues.push_back(std::make_unique<Queue>());
+
+	m_workers.reserve(threadCount);
+	for (size_t i = 0; i < threadCount; ++i)
+		m_workers.emplace_back(&ThreadPool::WorkerLoop, this, i);
+}
+
+ThreadPool::~ThreadPool()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_stopping = true;
+	}
+	m_taskReady.notify_all();
+
+	for (auto& worker : m_workers)
+		worker.join();
+}
+
+void ThreadPool::Submit(Task_t task)
+{
+	// keep work submitted by a task close to the worker running it
+	const auto index = (t_pool == this) ? t_index : m_nextQueue++ % m_queues.size();
+
+	++m_pending;
+
+	// counted before it can be taken, so taking it never brings m_queued below 0
+	{
+		auto& queue = *m_queues[index];
+		std::lock_guard<std::mutex> lock(queue.mutex);
+		++m_queued;
+		queue.tasks.push_back(std::move(task));
+	}
+
+	// taking the lock makes sure a worker about to sleep sees the new task
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+	}
+	m_taskReady.notify_one();
+}
+
+void ThreadPool::Wait()
+{
+	const Trace::Span span("wait for tasks");
+
+	// the task calling us is pending too, so this would never return
+	if (t_pool == this)
+		throw ErrorCode(Framework::ErrorCode_DEADLOCK);
+
+	std::unique_lock<std::mutex> lock(m_mutex);
+	m_tasksDone.wait(lock, [this] { return m_pending == 0; });
+
+	if (m_error != nullptr)
+	{
+		auto error = m_error;
+		m_error = nullptr;
+		std::rethrow_exception(error);
+	}
+}
+
+void ThreadPool::ParallelFor(size_t count, const std::function<void(size_t)>& func)
+{
+	if (count == 0)
+		return;
+
+	// only waits for its own tasks, so it also works from a task on this pool
+	struct Batch
+	{
+		std::atomic<size_t> next;
+		std::atomic<size_t> running;
+		std::mutex mutex;
+		std::exception_ptr error;
+	};
+
+	Batch batch;
+	batch.next = 0;
+
+	// workers pull indices as they finish, so uneven work still balances
+	const auto run = [&batch, count, &func]
+	{
+		try
+		{
+			for (auto index = batch.next++; index < count; index = batch.next++)
+				func(index);
+		}
+		catch (...)
+		{
+			std::lock_guard<std::mutex> lock(batch.mutex);
+			if (batch.error == nullptr)
+				batch.error = std::current_exception();
+
+			// skip the indices nobody has started
+			batch.next = count;
+		}
+	};
+
+	// the calling thread takes a share too
+	const auto taskCount = std::min(count, m_workers.size()) - 1;
+	batch.running = taskCount;
+
+	for (size_t i = 0; i < taskCount; ++i)
+	{
+		Submit([this, &batch, &run]
+		{
+			run();
+
+			if (--batch.running == 0)
+			{
+				std::lock_guard<std::mutex> lock(m_mutex);
+				m_tasksDone.notify_all();
+			}
+		});
+	}
+
+	run();
+
+	{
+		const Trace::Span span("wait for tasks");
+
+		// on a worker, our tasks may be queued behind others while every worker waits like us, so run queued work
+		// until ours is done
+		const auto helping = (t_pool == this);
+		while (batch.running != 0)
+		{
+			Task_t task;
+			if (helping == true && TakeTask(t_index, task) == true)
+			{
+				RunTask(task);
+				continue;
+			}
+
+			std::unique_lock<std::mutex> lock(m_mutex);
+			m_tasksDone.wait(lock, [this, &batch, helping] { return batch.running == 0 || (helping == true && m_queued != 0); });
+		}
+	}
+
+	if (batch.error != nullptr)
+		std::rethrow_exception(batch.error);
+}
+
+size_t ThreadPool::GetThreadCount() const noexcept
+{
+	return m_workers.size();
+}
+
+void ThreadPool::WorkerLoop(size_t index)
+{
+	t_pool = this;
+	t_index = index;
+
+	while (true)
+	{
+		Task_t task;
+
+		if (TakeTask(index, task) == false)
+		{
+			std::unique_lock<std::mutex> lock(m_mutex);
+			m_taskReady.wait(lock, [this] { return m_stopping == true || m_queued != 0; });
+
+			// only stop once every queue has drained
+			if (m_queued == 0)
+				return;
+
+			continue;
+		}
+
+		RunTask(task);
+	}
+}
+
+void ThreadPool::RunTask(Task_t& task)
+{
+	try
+	{
+		task();
+	}
+	catch (...)
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		if (m_error == nullptr)
+			m_error = std::current_exception();
+	}
+
+	if (--m_pending == 0)
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_tasksDone.notify_all();
+	}
+}
+
+bool ThreadPool::TakeTask(size_t index, Task_t& task)
+{
+	// newest work of our own first, it is the most likely to still be in cache
+	{
+		auto& queue = *m_queues[index];
+		std::lock_guard<std::mutex> lock(queue.mutex);
+
+		if (queue.tasks.empty() == false)
+		{
+			task = std::move(queue.tasks.back());
+			queue.tasks.pop_back();
+			--m_queued;
+			return true;
+		}
+	}
+
+	// otherwise steal the oldest work of another worker
+	for (size_t i = 1; i < m_queues.size(); ++i)
+	{
+		auto& queue = *m_queues[(index + i) % m_queues.size()];
+		std::lock_guard<std::mutex> lock(queue.mutex);
+
+		if (queue.tasks.empty() == false)
+		{
+			task = std::move(queue.tasks.front());
+			queue.tasks.pop_front();
+			--m_queued;
+			return true;
+		}
+	}
+
+	return false;
+}
@@ -0,0 +1,247 @@
+#include <Framework/Trace.h>
+
+#include <Framework/Json.h>
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+using Framework::ErrorCode;
+using Framework::Json;
+using Framework::Trace;
+
+std::atomic<bool> Trace::s_enabled{ false };
+
+namespace
+{
+	// the detail of a span, in words so it can be copied while it is overwritten
+	constexpr size_t DETAIL_WORDS = (Trace::DETAIL_SIZE + 1 + sizeof(uint64_t) - 1) / sizeof(uint64_t);
+
+	// a span in a ring. every field is atomic, so Write can read a span while its thread overwrites it, and the
+	// sequence tells whether it did
+	struct Event
+	{
+		// 2 * n + 1 while the nth span of the ring is written into it, and 2 * n + 2 once it has been
+		std::atomic<uint64_t> sequence{ 0 };
+		std::atomic<const char*> name{ nullptr };
+		std::atomic<int64_t> start{ 0 };
+		std::atomic<int64_t> end{ 0 };
+		std::array<std::atomic<uint64_t>, DETAIL_WORDS> detail{};
+	};
+
+	// a span copied out of a ring
+	struct Snapshot
+	{
+		const char* name;
+		int64_t start;
+		int64_t end;
+		char detail[DETAIL_WORDS * sizeof(uint64_t)];
+	};
+
+	// copies the nth span of a ring. returns false if it was overwritten or is being written
+	bool TakeSnapshot(const Event& event, uint64_t n, Snapshot& snapshot) noexcept
+	{
+		const auto sequence = event.sequence.load(std::memory_order_acquire);
+		if (sequence != 2 * n + 2)
+			return false;
+
+		snapshot.name = event.name.load(std::memory_order_relaxed);
+		snapshot.start = event.start.load(std::memory_order_relaxed);
+		snapshot.end = event.end.load(std::memory_order_relaxed);
+
+		uint64_t words[DETAIL_WORDS];
+		for (size_t i = 0; i < DETAIL_WORDS; ++i)
+			words[i] = event.detail[i].load(std::memory_order_relaxed);
+		memcpy(snapshot.detail, words, sizeof(words));
+
+		// the copy only holds if nothing started writing over it meanwhile
+		std::atomic_thread_fence(std::memory_order_acquire);
+		return event.sequence.load(std::memory_order_relaxed) == sequence;
+	}
+
+	// the spans of one thread. only that thread writes, and it publishes each span by moving the head past it
+	struct Ring
+	{
+		std::array<Event, Trace::RING_SIZE> events;
+		std::atomic<uint64_t> head{ 0 };
+		// the lane of the thread in the timeline
+		size_t index;
+	};
+
+	// every ring ever handed out. rings of threads that exited are handed to new threads, with their spans
+	struct Registry
+	{
+		std::mutex mutex;
+		std::vector<std::unique_ptr<Ring>> rings;
+		std::vector<Ring*> freeRings;
+	};
+
+	Registry& GetRegistry()
+	{
+		static Registry registry;
+		return registry;
+	}
+
+	// holds a thread's ring, and gives it back when the thread exits
+	struct RingOwner
+	{
+		RingOwner()
+		{
+			auto& registry = GetRegistry();
+			std::lock_guard<std::mutex> lock(registry.mutex);
+
+			if (registry.freeRings.empty() == false)
+			{
+				ring = registry.freeRings.back();
+				registry.freeRings.pop_back();
+				return;
+			}
+
+			registry.rings.push_back(std::make_unique<Ring>());
+			ring = registry.rings.back().get();
+			ring->index = registry.rings.size();
+		}
+
+		~RingOwner()
+		{
+			auto& registry = GetRegistry();
+			std::lock_guard<std::mutex> lock(registry.mutex);
+
+			registry.freeRings.push_back(ring);
+		}
+
+		Ring* ring;
+	};
+
+	Ring& GetRing()
+	{
+		thread_local RingOwner owner;
+		return *owner.ring;
+	}
+
+	// all times are from here, which is as early as the first span
+	const auto g_epoch = std::chrono::steady_clock::now();
+}
+
+void Trace::SetEnabled(bool enabled) noexcept
+{
+	s_enabled.store(enabled, std::memory_order_relaxed);
+}
+
+void Trace::Write(const std::string& fileName)
+{
+	std::ofstream fileOut(fileName, std::ios::binary | std::ios::trunc);
+
+	if (fileOut.good() == false)
+		throw ErrorCode(ErrorCode_FILENOTOPEN);
+
+	fileOut << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+
+	auto& registry = GetRegistry();
+	std::lock_guard<std::mutex> lock(registry.mutex);
+
+	bool first = true;
+	char number[64];
+
+	for (const auto& ring : registry.rings)
+	{
+		// name the lane, so it is not just a number
+		fileOut << (first ? "" : ",") << "\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << ring->index
+			<< ",\"args\":{\"name\":\"thread " << ring->index << "\"}}";
+		first = false;
+
+		// only the last RING_SIZE spans are still there
+		const auto head = ring->head.load(std::memory_order_acquire);
+		const auto count = std::min<uint64_t>(head, RING_SIZE);
+
+		for (auto i = head - count; i < head; ++i)
+		{
+			// the thread may still be recording, and spans it overwrote meanwhile are skipped
+			Snapshot event;
+			if (TakeSnapshot(ring->events[i % RING_SIZE], i, event) == false)
+				continue;
+
+			// chrome wants microseconds
+			snprintf(number, sizeof(number), "%.3f,\"dur\":%.3f", event.start / 1e3, (event.end - event.start) / 1e3);
+
+			fileOut << ",\n{\"name\":\"";
+			fileOut << Json::Escape(event.name);
+			fileOut << "\",\"cat\":\"framework\",\"ph\":\"X\",\"pid\":1,\"tid\":" << ring->index << ",\"ts\":" << number;
+
+			if (event.detail[0] != '\0')
+			{
+				fileOut << ",\"args\":{\"detail\":\"";
+				fileOut << Json::Escape(event.detail);
+				fileOut << "\"}";
+			}
+
+			fileOut << '}';
+		}
+	}
+
+	fileOut << "\n]}\n";
+	fileOut.flush();
+
+	if (fileOut.good() == false)
+		throw ErrorCode(ErrorCode_FILENOTOPEN);
+}
+
+void Trace::Write(const std::string& fileName, ErrorCode& ec) noexcept
+{
+	try
+	{
+		Write(fileName);
+	}
+	catch (const ErrorCode& e)
+	{
+		ec = e;
+	}
+}
+
+void Trace::Clear() noexcept
+{
+	auto& registry = GetRegistry();
+	std::lock_guard<std::mutex> lock(registry.mutex);
+
+	for (const auto& ring : registry.rings)
+		ring->head.store(0, std::memory_order_release);
+}
+
+int64_t Trace::GetTime() noexcept
+{
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - g_epoch).count();
+}
+
+void Trace::Record(const char* name, std::string_view detail, int64_t start, int64_t end) noexcept
+{
+	auto& ring = GetRing();
+	const auto head = ring.head.load(std::memory_order_relaxed);
+
+	auto& event = ring.events[head % RING_SIZE];
+
+	// mark the span as being written before any of it changes
+	event.sequence.store(2 * head + 1, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_release);
+
+	event.name.store(name, std::memory_order_relaxed);
+	event.start.store(start, std::memory_order_relaxed);
+	event.end.store(end, std::memory_order_relaxed);
+
+	// keep the end of long details, such as paths, where the name is
+	if (detail.size() > DETAIL_SIZE)
+		detail.remove_prefix(detail.size() - DETAIL_SIZE);
+
+	uint64_t words[DETAIL_WORDS] = {};
+	memcpy(words, detail.data(), detail.size());
+	for (size_t i = 0; i < DETAIL_WORDS; ++i)
+		event.detail[i].store(words[i], std::memory_order_relaxed);
+
+	event.sequence.store(2 * head + 2, std::memory_order_release);
+	ring.head.store(head + 1, std::memory_order_release);
+}